@@ -10,14 +10,22 @@
 #include <iomanip>
 #include <thread>
 #include <memory>
+#include <cstdlib>
+#include <string_view>
 #include "core/Misc.h"
 
 #include "core/Fen.h"
 #include "core/Board.h"
+#include "core/eval/Nnue.h"
 #include "ai/Facade.h"
+#include "ai/Evaluation.h"
 
 #include "database/BookMoveSelector.h"
 #include "ai/Search.h"
+#include "ai/BatchEvaluator.h"
+#include "ai/MateSolver.h"
+#include "database/Bitbase.h"
+#include "database/Syzygy.h"
 
 class ChessState
 {
@@ -31,10 +39,24 @@ public:
 	chess::core::pieces::Color SetFen(const std::string_view fen)
 	{
 		std::scoped_lock lock(m_Mutex);
+		const auto networkLock = chess::core::eval::nnue::LockNetwork();
 		chess::core::fen::SetFen(m_Board, fen);
 		return m_Board.colorToPlay();
 	}
 
+	bool LoadNetwork(const std::string_view path)
+	{
+		std::scoped_lock lock(m_Mutex);
+		if (!chess::core::eval::nnue::LoadNetwork(path))
+		{
+			return false;
+		}
+
+		const auto networkLock = chess::core::eval::nnue::LockNetwork();
+		m_Board.RefreshAccumulator();
+		return true;
+	}
+
 	void WaitForUnlock()
 	{
 		std::scoped_lock lock(m_Mutex);
@@ -63,21 +85,72 @@ public:
 		};
 
 		std::scoped_lock lock(m_Mutex);
+		const auto networkLock = chess::core::eval::nnue::LockNetwork();
 		m_SearchPtr = std::make_unique<chess::ai::details::Search>(m_BookMoveSelectorPtr.get());
-		m_SearchPtr->StartSearch(m_Board.CloneWithoutHistory(), params,
-				verbose, &hook);
+		// The network may have been loaded through another state
+		auto board = m_Board.CloneWithoutHistory();
+		board.RefreshAccumulator();
+		m_SearchPtr->StartSearch(board, params, verbose, &hook);
 		return bestMove;
 	}
 
+	// Lines of the deepest completed iteration, best first
+	std::vector<chess::ai::SearchResult> SearchLines(const chess::ai::SearchParams params, const bool verbose)
+	{
+		std::vector<chess::ai::SearchResult> lines;
+
+		const chess::ai::details::SearchResultHook hook = [&lines](const chess::ai::SearchResult& result)
+		{
+			if (!lines.empty() && lines.front().Depth != result.Depth)
+			{
+				lines.clear();
+			}
+			lines.push_back(result);
+		};
+
+		std::scoped_lock lock(m_Mutex);
+		const auto networkLock = chess::core::eval::nnue::LockNetwork();
+		m_SearchPtr = std::make_unique<chess::ai::details::Search>(m_BookMoveSelectorPtr.get());
+		auto board = m_Board.CloneWithoutHistory();
+		board.RefreshAccumulator();
+		m_SearchPtr->StartSearch(board, params, verbose, nullptr, &hook);
+		return lines;
+	}
+
+	chess::ai::MateSolver::Result SolveMate(const chess::ai::SearchParams params)
+	{
+		std::scoped_lock lock(m_Mutex);
+		const auto networkLock = chess::core::eval::nnue::LockNetwork();
+		chess::ai::MateSolver solver(params.TableSize > 0 ? params.TableSize
+														   : chess::ai::MateSolver::DEFAULT_TABLE_SIZE);
+		return solver.Solve(m_Board, params.MateMoves, params.MaxTime, (size_t)std::max(0, params.MaxNodes));
+	}
+
+	int EvaluateBatch(const char* const* fens, const int count, const int depth, const int maxWorkers, int* scores)
+	{
+		std::scoped_lock lock(m_Mutex);
+		const auto networkLock = chess::core::eval::nnue::LockNetwork();
+
+		const int workerCount = maxWorkers > 0 ? maxWorkers : (int)std::max(1u, std::thread::hardware_concurrency());
+		if (!m_BatchEvaluatorPtr || m_BatchEvaluatorPtr->workerCount() != workerCount)
+		{
+			m_BatchEvaluatorPtr = std::make_unique<chess::ai::BatchEvaluator>(workerCount);
+		}
+
+		return m_BatchEvaluatorPtr->Evaluate(fens, count, depth, scores);
+	}
+
 	void MakeMove(const chess::core::moves::Move move)
 	{
 		std::scoped_lock lock(m_Mutex);
+		const auto networkLock = chess::core::eval::nnue::LockNetwork();
 		m_Board.MakeMove(move);
 	}
 
 	void UndoMove()
 	{
 		std::scoped_lock lock(m_Mutex);
+		const auto networkLock = chess::core::eval::nnue::LockNetwork();
 		m_Board.UndoMove();
 	}
 
@@ -86,6 +159,7 @@ private:
 	chess::core::Board m_Board;
 	std::unique_ptr<chess::database::BookMoveSelector> m_BookMoveSelectorPtr;
 	std::unique_ptr<chess::ai::details::Search> m_SearchPtr = nullptr;
+	std::unique_ptr<chess::ai::BatchEvaluator> m_BatchEvaluatorPtr = nullptr;
 };
 
 extern "C"
@@ -101,6 +175,39 @@ void LoadOpeningBook(ChessState* state, const char* const path)
 	state->LoadBook(path);
 }
 
+// Switches evaluation to the network for every state, returns 0 if it could not be loaded
+int LoadNetwork(ChessState* state, const char* const path)
+{
+	assert(state);
+	return state->LoadNetwork(path);
+}
+
+// Side to move relative scores of count FENs: static evaluation for depth 0, fixed depth search otherwise.
+// Worker threads are kept alive between calls, maxWorkers 0 uses all cores. Returns the number of invalid FENs
+int EvaluateBatch(ChessState* state, const char* const* fens, const int count, const int depth, const int maxWorkers,
+		int* scores)
+{
+	assert(state);
+	return state->EvaluateBatch(fens, count, depth, maxWorkers, scores);
+}
+
+// Generates the three-man KPK, KRK and KQK bitbases up front instead of on first use. With a cache directory
+// the four-man ones are loaded as well, all of them memory-mapped from there or stored there after generation.
+// cacheDirectory may be null
+int InitBitbases(const char* const cacheDirectory)
+{
+	return chess::database::bitbase::Init(cacheDirectory ? cacheDirectory : "");
+}
+
+// Memory-maps Syzygy tables from path (directories separated by ':'), returns the largest covered piece count.
+// 0 if none were found or tablebase support was not compiled in
+int InitTablebases(const char* const path)
+{
+	assert(path);
+	chess::database::syzygy::Init(path);
+	return chess::database::syzygy::GetMaxPieces();
+}
+
 void FreeState(ChessState* state)
 {
 	assert(state);
@@ -162,6 +269,65 @@ void TimePerft(std::string_view fen, int depth)
 			  std::fixed << std::setprecision(3) << (double)nodes / passed_t.count() / 1000'000.0 << '\n';
 }
 
+void CollectPositions(chess::core::Board& board, int depth, std::vector<chess::core::Board>& positions)
+{
+	positions.push_back(board.CloneWithoutHistory());
+	if (depth == 0)
+	{
+		return;
+	}
+
+	chess::core::moves::Move moves[chess::core::moves::MAX_MOVES];
+	const auto end = chess::core::moves::GenerateMoves<chess::core::moves::Legality::Legal>(board, moves);
+	for (auto it = moves; it != end; it++)
+	{
+		board.MakeMove(*it);
+		CollectPositions(board, depth - 1, positions);
+		board.UndoMove();
+	}
+}
+
+// Static evaluation speed over every position of a small tree, without pawn table so every call does full work
+void TimeEvaluation(std::string_view fen, int depth, int repeats = 10)
+{
+	chess::core::Board board;
+	chess::core::fen::SetFen(board, fen);
+
+	std::vector<chess::core::Board> positions;
+	CollectPositions(board, depth, positions);
+
+	long long checksum = 0;
+	auto start_t = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < repeats; i++)
+	{
+		for (const auto& position : positions)
+		{
+			checksum += chess::ai::eval::EvaluateBoard(position);
+		}
+	}
+	auto passed_t = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_t);
+	std::cout << fen << "  - Positions: " << positions.size() << ". Ns p/eval: " << std::fixed
+			  << std::setprecision(1) << passed_t.count() * 1e9 / (double)(positions.size() * repeats)
+			  << " (checksum " << checksum << ")\n";
+}
+
+// Depth of "CppChessAi bench" without a depth argument
+constexpr int DEFAULT_BENCH_DEPTH = 11;
+
+// Positions searched by Bench: openings, middlegames with tactics, and endgames
+constexpr std::array<std::string_view, 10> BENCH_FENS{
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+		"r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+		"2r3k1/pp3ppp/2n1b3/3p4/3P4/2N1B3/PP3PPP/2R3K1 w - - 0 1",
+		"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+		"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+		"8/8/1p2k3/p1p2p2/P1P2P2/1P2K3/8/8 w - - 0 1",
+		"r1b1k2r/ppppnppp/2n2q2/2b5/3NP3/2P1B3/PP3PPP/RN1QKB1R w KQkq - 0 1",
+		"4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+		"r1bq1rk1/pp2bppp/2n2n2/3p4/3P4/2NB1N2/PP3PPP/R1BQ1RK1 w - - 0 9",
+};
+
 void DividePerft(std::string_view fen, int depth)
 {
 	std::vector<std::pair<chess::core::moves::Move, size_t>> divide;
@@ -208,12 +374,7 @@ int GetBoardState(ChessState* state)
 		return REPETITION_STALEMATE;
 	}
 
-	using namespace chess::core::moves;
-
-	Move moves[MAX_MOVES];
-	const auto end = GenerateMoves<Legality::Legal>(state->board(), moves);
-	const bool hasMoves = end != moves;
-	if (!hasMoves)
+	if (!chess::core::moves::HasLegalMove(state->board()))
 	{
 		return state->board().checkers() ? CHECKMATE : NO_MOVES_STALEMATE;
 	}
@@ -226,18 +387,88 @@ int Search(ChessState* state, const chess::ai::SearchParams params, const int ve
 	std::cout << "Starting search:\n"
 			  << "State address=" << &state << '\n'
 			  << "Max time=" << params.MaxTime << '\n'
+			  << "Remaining time=" << params.RemainingTime << '\n'
+			  << "Increment=" << params.Increment << '\n'
+			  << "Moves to go=" << params.MovesToGo << '\n'
 			  << "Max workers=" << params.MaxWorkers << '\n'
 			  << "Max depth=" << params.MaxDepth << '\n'
 			  << "Table size=" << params.TableSize << '\n'
 			  << "Table bucket size=" << params.TableBucketSize << '\n'
 			  << "Book temperature=" << params.BookTemperature << '\n'
+			  << "Mate moves=" << params.MateMoves << '\n'
+			  << "MultiPV=" << params.MultiPv << '\n'
 			  << "Verbose=" << verbose << std::endl;
 	const auto bestMove = state->Search(params, verbose);
 	return bestMove.value();
 }
 
+// Searches params.MultiPv best root moves, each with its own line. For the deepest completed iteration, best first,
+// writes up to maxLines scores, line lengths and lines of raw moves, maxLineLength moves apart. Returns the line count
+int SearchLines(ChessState* state, const chess::ai::SearchParams params, const int verbose, int* scores,
+		int* lineLengths, int* lines, const int maxLines, const int maxLineLength)
+{
+	assert(state);
+	const auto results = state->SearchLines(params, verbose);
+	const int count = std::min(maxLines, (int)results.size());
+	for (int i = 0; i < count; i++)
+	{
+		const int length = std::min(maxLineLength, (int)results[i].PV.size());
+		scores[i] = results[i].Score;
+		lineLengths[i] = length;
+		for (int j = 0; j < length; j++)
+		{
+			lines[i * maxLineLength + j] = results[i].PV[j].value();
+		}
+	}
+	return count;
+}
+
+// Proves a mate in up to params.MateMoves moves within params.MaxTime and params.MaxNodes. Writes up to maxLength
+// plies of the mating line as raw moves and returns its full length, 0 if there is no such mate and -1 if the
+// budget ran out first
+int SolveMate(ChessState* state, const chess::ai::SearchParams params, int* line, const int maxLength)
+{
+	assert(state);
+	const auto result = state->SolveMate(params);
+	if (result.Outcome != chess::ai::MateSolver::Status::Mate)
+	{
+		return result.Outcome == chess::ai::MateSolver::Status::NoMate ? 0 : -1;
+	}
+
+	for (int i = 0; i < std::min(maxLength, (int)result.Line.size()); i++)
+	{
+		line[i] = result.Line[i].value();
+	}
+	return (int)result.Line.size();
+}
+
+// Fixed depth single threaded search over the bench positions. The total node count is a signature of the
+// search: it only changes with changes to the search or evaluation
+void Bench(const int depth)
+{
+	const auto networkLock = chess::core::eval::nnue::LockNetwork();
+	chess::ai::details::FixedDepthSearch search(1 << 20);
+	chess::core::Board board;
+
+	size_t totalNodes = 0;
+	const auto start_t = std::chrono::high_resolution_clock::now();
+	for (const auto fen : BENCH_FENS)
+	{
+		chess::core::fen::SetFen(board, fen);
+		const auto score = search.Run(board, depth);
+		totalNodes += search.nodes();
+		std::cout << fen << "  - Score: " << score << ". Nodes: " << search.nodes() << '\n';
+	}
+	const auto passed_t = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_t);
+
+	std::cout << "Bench: depth " << depth << " nodes " << totalNodes << " time " << std::fixed
+			  << std::setprecision(2) << passed_t.count() << "s nps " << (size_t)((double)totalNodes / passed_t.count())
+			  << std::endl;
+}
+
 int HealthCheck()
 {
+	const auto networkLock = chess::core::eval::nnue::LockNetwork();
 	const std::string startFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 #ifdef NDEBUG
 	TimePerft(startFen, 6);
@@ -252,6 +483,9 @@ int HealthCheck()
 #endif
 
 	const std::string fen2 = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -";
+#ifdef NDEBUG
+	TimeEvaluation(fen2, 3);
+#endif
 	CheckPerft(fen2, 1, 48);
 	CheckPerft(fen2, 2, 2039);
 	CheckPerft(fen2, 3, 97862);
@@ -287,8 +521,21 @@ void Thread(ChessState* state)
 	Search(state, params, true);
 }
 
-int main()
+int main(const int argc, const char* const argv[])
 {
+	// "bench [depth]" prints the node signature and exits
+	if (argc > 1 && std::string_view(argv[1]) == "bench")
+	{
+		Bench(argc > 2 ? std::max(1, std::atoi(argv[2])) : DEFAULT_BENCH_DEPTH);
+		return 0;
+	}
+
+	// "bitbases <directory>" generates the bitbase files there ahead of time and exits
+	if (argc > 2 && std::string_view(argv[1]) == "bitbases")
+	{
+		return InitBitbases(argv[2]) ? 0 : 1;
+	}
+
 	auto* state = CreateState();
 	//state->LoadBook("../database/book.bin");
 	using namespace std::chrono_literals;
@@ -0,0 +1,119 @@
+//
+// Created by matvey on 18.10.26.
+//
+
+#include "BatchEvaluator.h"
+
+#include "Evaluation.h"
+#include "../core/Fen.h"
+
+namespace chess::ai
+{
+	BatchEvaluator::BatchEvaluator(const int workerCount)
+	{
+		const int count = std::max(1, workerCount);
+		for (int i = 0; i < count; i++)
+		{
+			m_Workers.push_back(std::make_unique<Worker>());
+		}
+
+		for (auto& worker : m_Workers)
+		{
+			m_Threads.emplace_back(&BatchEvaluator::WorkerLoop, this, std::ref(*worker));
+		}
+	}
+
+	BatchEvaluator::~BatchEvaluator()
+	{
+		{
+			std::scoped_lock lock(m_Mutex);
+			m_Exit = true;
+		}
+		m_WorkReady.notify_all();
+
+		for (auto& thread : m_Threads)
+		{
+			thread.join();
+		}
+	}
+
+	int BatchEvaluator::Evaluate(const char* const* fens, const int count, const int depth, int* scores)
+	{
+		if (count <= 0)
+		{
+			return 0;
+		}
+
+		std::unique_lock lock(m_Mutex);
+		m_Fens = fens;
+		m_Count = count;
+		m_Depth = depth;
+		m_Scores = scores;
+		m_NextIndex = 0;
+		m_Failed = 0;
+		m_BusyWorkers = workerCount();
+		m_Generation++;
+
+		m_WorkReady.notify_all();
+		m_WorkDone.wait(lock, [this]()
+		{
+			return m_BusyWorkers == 0;
+		});
+
+		return m_Failed;
+	}
+
+	void BatchEvaluator::WorkerLoop(Worker& worker)
+	{
+		uint64_t generation = 0;
+		while (true)
+		{
+			{
+				std::unique_lock lock(m_Mutex);
+				m_WorkReady.wait(lock, [this, generation]()
+				{
+					return m_Exit || m_Generation != generation;
+				});
+
+				if (m_Exit)
+				{
+					return;
+				}
+				generation = m_Generation;
+			}
+
+			// Positions are handed out one by one, search times vary a lot between them
+			for (int index = m_NextIndex++; index < m_Count; index = m_NextIndex++)
+			{
+				EvaluateOne(worker, index);
+			}
+
+			{
+				std::scoped_lock lock(m_Mutex);
+				if (--m_BusyWorkers == 0)
+				{
+					m_WorkDone.notify_one();
+				}
+			}
+		}
+	}
+
+	void BatchEvaluator::EvaluateOne(Worker& worker, const int index)
+	{
+		if (!m_Fens[index] || !core::fen::SetFen(worker.Board, m_Fens[index]))
+		{
+			m_Scores[index] = INVALID_SCORE;
+			m_Failed++;
+			return;
+		}
+
+		if (m_Depth <= 0)
+		{
+			m_Scores[index] = eval::EvaluateBoard(worker.Board, { &worker.PawnTable, &worker.MaterialTable });
+		}
+		else
+		{
+			m_Scores[index] = worker.Search.Run(worker.Board, m_Depth);
+		}
+	}
+}
@@ -0,0 +1,72 @@
+//
+// Created by matvey on 18.10.26.
+//
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <limits>
+
+#include "Search.h"
+#include "hash/PawnTable.h"
+#include "hash/MaterialTable.h"
+
+namespace chess::ai
+{
+	// Scores many positions per call on a persistent pool of workers. Every worker keeps its board and tables
+	// between calls, so a batch does not allocate
+	class BatchEvaluator
+	{
+	public:
+		static constexpr int INVALID_SCORE = std::numeric_limits<int>::min();
+
+		explicit BatchEvaluator(int workerCount);
+		~BatchEvaluator();
+
+		BatchEvaluator(const BatchEvaluator&) = delete;
+		BatchEvaluator& operator=(const BatchEvaluator&) = delete;
+
+		// Side to move relative static evaluation for depth 0, fixed depth search score otherwise.
+		// Positions that fail to parse get INVALID_SCORE, their count is returned
+		int Evaluate(const char* const* fens, int count, int depth, int* scores);
+
+		NODISCARD int workerCount() const
+		{
+			return (int)m_Threads.size();
+		}
+
+	private:
+		struct Worker
+		{
+			core::Board Board;
+			hash::PawnTable PawnTable;
+			hash::MaterialTable MaterialTable;
+			details::FixedDepthSearch Search;
+		};
+
+		void WorkerLoop(Worker& worker);
+		void EvaluateOne(Worker& worker, int index);
+
+		std::vector<std::unique_ptr<Worker>> m_Workers;
+		std::vector<std::thread> m_Threads;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_WorkReady;
+		std::condition_variable m_WorkDone;
+		uint64_t m_Generation = 0;
+		int m_BusyWorkers = 0;
+		bool m_Exit = false;
+
+		const char* const* m_Fens = nullptr;
+		int m_Count = 0;
+		int m_Depth = 0;
+		int* m_Scores = nullptr;
+		std::atomic_int m_NextIndex = 0;
+		std::atomic_int m_Failed = 0;
+	};
+}
@@ -12,6 +12,8 @@ namespace chess::ai
 	struct SearchResult
 	{
 		int Depth{};
+		// MultiPV rank, 0 for the best line
+		int MultiPvIndex{};
 		int SelDepth{};
 		int Score{};
 		size_t Nodes{};
@@ -5,6 +5,11 @@
 #include "Evaluation.h"
 
 #include "../core/Board.h"
+#include "../core/Lookups.h"
+#include "../core/Magic.h"
+#include "../database/Bitbase.h"
+
+#include <limits>
 
 namespace chess::ai::eval
 {
@@ -12,117 +17,319 @@ namespace chess::ai::eval
 
 	namespace
 	{
-		constexpr std::array<int, pieces::PIECES> PIECE_SCORES{ 100, 290, 310, 515, 900, 2000 };
 		constexpr std::array<int, BOARD_SIZE> PAWN_PASSED_SCORES{ 0, 5, 10, 20, 40, 80, 160, 0 };
 		constexpr std::array<int, pieces::PIECES> PIECE_PINNED_SCORES{ 10, 25, 25, 35, 100, 0 };
 
 		constexpr int PAWN_ISOLATED_SCORE = -20;
+		constexpr int PAWN_DOUBLED_SCORE = -10;
 		constexpr int ROOK_ON_OPEN_RANK_SCORE = 30;
 		constexpr int ROOK_ON_SEMI_OPEN_RANK_SCORE = 13;
 		constexpr int CHECK_SCORE = 10;
 		constexpr int DOUBLE_CHECK_SCORE = 50;
-		constexpr int BISHOP_PAIR_SCORE = 20;
-		constexpr int BISHOP_PAIR_END_GAME_SCORE = 70;
+		constexpr core::eval::PackedScore BISHOP_PAIR_SCORE{ 20, 70 };
+		constexpr int MINOR_PIECE_PAWN_SCORE = 6;
+		constexpr int MINOR_PIECE_PAWN_PIVOT = 10;
+
+		// Tuned, not a bound: rook file and pin terms are skipped when the rest of the evaluation is this far
+		// outside the window. Several pins and open files together can exceed it, so a lazy score may land on
+		// the wrong side of the window. It is never cached
+		constexpr int LAZY_MARGIN = 150;
+
+		// Without pawns, a material edge below this is not enough to win
+		constexpr int MIN_WINNING_EDGE = PIECE_SCORES[(int)pieces::Type::Bishop];
+		constexpr int OPPOSITE_BISHOPS_SCALE = hash::MaterialEntry::SCALE_NORMAL / 2;
+
+		constexpr Bitboard FILE_A{ 0x0101010101010101ULL };
+		constexpr Bitboard FILE_H = FILE_A << (BOARD_SIZE - 1);
+		constexpr Bitboard RANK_0{ 0xFFULL };
+		// a8 is a light square
+		constexpr Bitboard LIGHT_SQUARES{ 0xAA55AA55AA55AA55ULL };
+		constexpr Bitboard CORNERS{ 0x8100000000000081ULL };
+
+		// Black pawns advance towards higher square indices, white pawns towards lower ones
+		constexpr Bitboard FillTowardsBlack(Bitboard bitboard)
+		{
+			bitboard |= bitboard >> 8;
+			bitboard |= bitboard >> 16;
+			bitboard |= bitboard >> 32;
+			return bitboard;
+		}
 
-		auto GetPieceScoreTweak(const Board& board, const Square square, const pieces::Piece piece,
-				const auto pawnCount)
+		constexpr Bitboard FillTowardsWhite(Bitboard bitboard)
 		{
-			if (piece.type() == core::pieces::Type::Pawn)
-			{
-				int tweak = 0;
+			bitboard |= bitboard << 8;
+			bitboard |= bitboard << 16;
+			bitboard |= bitboard << 32;
+			return bitboard;
+		}
+
+		constexpr Bitboard GetFrontSpan(const Bitboard pawns, const pieces::Color color)
+		{
+			return color == pieces::Color::White ? FillTowardsBlack(pawns >> 8) : FillTowardsWhite(pawns << 8);
+		}
+
+		constexpr Bitboard GetRearSpan(const Bitboard pawns, const pieces::Color color)
+		{
+			return GetFrontSpan(pawns, pieces::OppositeColor(color));
+		}
+
+		constexpr Bitboard GetAdjacentFiles(const Bitboard bitboard)
+		{
+			return ((bitboard << 1) & ~FILE_A) | ((bitboard >> 1) & ~FILE_H);
+		}
+
+		// Set-wise pawn terms for one side, white minus black sign applied by the caller
+		void EvaluatePawns(const Board& board, const pieces::Color color, hash::PawnEntry& entry)
+		{
+			const auto them = pieces::OppositeColor(color);
+			const auto allyPawnsBB = board.GetPieces(color, pieces::Type::Pawn);
+			const auto enemyPawnsBB = board.GetPieces(them, pieces::Type::Pawn);
 
-				const auto allyPawnsBB = board.GetPieces(piece.color(),
-						core::pieces::Type::Pawn);
-				const auto enemyPawnsBB = board.GetPieces(pieces::OppositeColor(piece.color()),
-						core::pieces::Type::Pawn);
+			const auto fileFillBB = FillTowardsBlack(allyPawnsBB) | FillTowardsWhite(allyPawnsBB);
+			const auto isolatedBB = allyPawnsBB & ~GetAdjacentFiles(fileFillBB);
+			const auto doubledBB = allyPawnsBB & GetRearSpan(allyPawnsBB, color);
 
-				const auto file = square.file();
-				const auto pawnFile = lookups::GetFile(file);
-				const auto leftFile = file > 0 ? lookups::GetFile(file - 1) : Bitboard();
-				const auto rightFile = file < BOARD_SIZE - 1 ? lookups::GetFile(file + 1) : Bitboard();
-				const bool isIsolated = !((leftFile | rightFile) & allyPawnsBB);
+			const auto enemyFrontSpanBB = GetFrontSpan(enemyPawnsBB, them);
+			const auto passedBB = allyPawnsBB & ~(enemyFrontSpanBB | GetAdjacentFiles(enemyFrontSpanBB));
 
-				if (isIsolated)
+			int passedScore = 0;
+			if (passedBB)
+			{
+				for (int rank = 1; rank < BOARD_SIZE - 1; rank++)
 				{
-					tweak += PAWN_ISOLATED_SCORE;
+					const int index = color == pieces::Color::Black ? rank : BOARD_SIZE - rank - 1;
+					passedScore += (passedBB & (RANK_0 << rank * BOARD_SIZE)).PopCount() * PAWN_PASSED_SCORES[index];
 				}
+			}
 
-				static constexpr auto filled = Bitboard(~0ULL);
+			const int structureScore = isolatedBB.PopCount() * PAWN_ISOLATED_SCORE
+					+ doubledBB.PopCount() * PAWN_DOUBLED_SCORE;
 
-				int passedTweak = 0;
+			const int sign = color == pieces::Color::White ? 1 : -1;
+			entry.StructureScore += structureScore * sign;
+			entry.PassedScore += passedScore * sign;
+		}
 
-				const auto adjacentFilesBB = pawnFile | leftFile | rightFile;
-				const auto shift = (square.rank() + 1) * BOARD_SIZE;
-				const auto passedCheckMask =
-						piece.color() == core::pieces::Color::Black ?
-						filled << shift : filled >> (BOARD_SQUARES - shift);
+		hash::PawnEntry EvaluatePawns(const Board& board)
+		{
+			hash::PawnEntry entry{ .Hash = board.pawnHash() };
+			EvaluatePawns(board, pieces::Color::White, entry);
+			EvaluatePawns(board, pieces::Color::Black, entry);
+			return entry;
+		}
+
+		auto EvaluatePawnStructure(const Board& board, hash::PawnTable* pawnTable)
+		{
+			std::optional<hash::PawnEntry> entry;
+			if (pawnTable)
+			{
+				entry = pawnTable->Probe(board.pawnHash());
+			}
 
-				if (!(passedCheckMask & adjacentFilesBB & enemyPawnsBB))
+			if (!entry.has_value())
+			{
+				entry = EvaluatePawns(board);
+				if (pawnTable)
 				{
-					const int index = piece.color() == core::pieces::Color::Black ?
-									  square.rank() : BOARD_SIZE - square.rank() - 1;
-					passedTweak = PAWN_PASSED_SCORES[index];
+					pawnTable->Insert(*entry);
 				}
+			}
 
-				tweak += board.IsEndGame() ? passedTweak * 2 : passedTweak;
-				return tweak;
+			// Passed pawns are worth twice as much once the pieces are off
+			return core::eval::PackedScore(entry->StructureScore, entry->StructureScore)
+					+ core::eval::PackedScore(entry->PassedScore, entry->PassedScore * 2);
+		}
+
+		// Knights gain and bishops lose value in closed positions
+		auto EvaluateMinorPieces(const Board& board)
+		{
+			const auto pawnCount = board.GetPieces(pieces::Type::Pawn).PopCount();
+			const auto knights = board.GetPieceCount(pieces::Color::White, pieces::Type::Knight)
+					- board.GetPieceCount(pieces::Color::Black, pieces::Type::Knight);
+			const auto bishops = board.GetPieceCount(pieces::Color::White, pieces::Type::Bishop)
+					- board.GetPieceCount(pieces::Color::Black, pieces::Type::Bishop);
+
+			return (knights - bishops) * (pawnCount - MINOR_PIECE_PAWN_PIVOT) * MINOR_PIECE_PAWN_SCORE;
+		}
+
+		auto EvaluateRooks(const Board& board, const pieces::Color color)
+		{
+			static constexpr int MAX_ROOKS = 10;
+
+			Square rookSquares[MAX_ROOKS];
+			const auto end = board.GetPieces(color, pieces::Type::Rook).BitScanForwardAll(rookSquares);
+			const auto pawnsBB = board.GetPieces(pieces::Type::Pawn);
+
+			int score = 0;
+			for (auto it = rookSquares; it != end; it++)
+			{
+				const auto pawnsOnRankBB = pawnsBB & lookups::GetRank(*it);
+				if (!pawnsOnRankBB)
+				{
+					score += ROOK_ON_OPEN_RANK_SCORE;
+				}
+				else if (!(pawnsOnRankBB & board.GetPieces(color)))
+				{
+					score += ROOK_ON_SEMI_OPEN_RANK_SCORE;
+				}
 			}
 
-			if (piece.type() == pieces::Type::Knight)
+			return score;
+		}
+
+		auto EvaluatePieceCounts(const Board& board)
+		{
+			core::eval::PackedScore score{};
+			if (board.GetPieceCount(core::pieces::Color::White, core::pieces::Type::Bishop) >= 2)
 			{
-				return (pawnCount - 10) * 6;
+				score += BISHOP_PAIR_SCORE;
 			}
-			if (piece.type() == pieces::Type::Bishop)
+			if (board.GetPieceCount(core::pieces::Color::Black, core::pieces::Type::Bishop) >= 2)
 			{
-				return (10 - pawnCount) * 6;
+				score -= BISHOP_PAIR_SCORE;
 			}
-			if (piece.type() != pieces::Type::Rook)
+
+			return score;
+		}
+
+		hash::MaterialEntry AnalyzeMaterial(const Board& board)
+		{
+			hash::MaterialEntry entry{ .Hash = board.materialHash() };
+
+			std::array<int, pieces::COLORS> pawns{}, nonPawnMaterial{};
+			for (int color = 0; color < pieces::COLORS; color++)
 			{
-				return 0;
+				pawns[color] = board.GetPieceCount((pieces::Color)color, pieces::Type::Pawn);
+				for (int type = (int)pieces::Type::Knight; type <= (int)pieces::Type::Queen; type++)
+				{
+					nonPawnMaterial[color] += board.GetPieceCount((pieces::Color)color, (pieces::Type)type)
+							* PIECE_SCORES[type];
+				}
 			}
 
-			const auto rankBB = lookups::GetRank(square);
-			const auto pawnsOnRankBB = board.GetPieces(pieces::Type::Pawn) & rankBB;
-			if (!pawnsOnRankBB)
+			const bool noPawns = pawns[0] == 0 && pawns[1] == 0;
+			if (noPawns && std::min(nonPawnMaterial[0], nonPawnMaterial[1]) == 0
+					&& std::max(nonPawnMaterial[0], nonPawnMaterial[1]) <= MIN_WINNING_EDGE)
 			{
-				return ROOK_ON_OPEN_RANK_SCORE;
+				entry.Type = hash::EndGame::Draw;
+				return entry;
 			}
-			if (!(pawnsOnRankBB & board.GetPieces(piece.color())))
+
+			for (int color = 0; color < pieces::COLORS; color++)
 			{
-				return ROOK_ON_SEMI_OPEN_RANK_SCORE;
+				const auto us = (pieces::Color)color;
+				const auto them = pieces::OppositeColor(us);
+				const auto count = [&board, us](const pieces::Type type)
+				{
+					return board.GetPieceCount(us, type);
+				};
+
+				if (pawns[(int)them] == 0 && nonPawnMaterial[(int)them] == 0)
+				{
+					entry.StrongSide = us;
+					const bool onlyMinors = count(pieces::Type::Rook) == 0 && count(pieces::Type::Queen) == 0;
+					if (pawns[color] == 0 && onlyMinors && count(pieces::Type::Knight) == 1
+							&& count(pieces::Type::Bishop) == 1)
+					{
+						entry.Type = hash::EndGame::KBNK;
+						return entry;
+					}
+					if (!onlyMinors || count(pieces::Type::Bishop) >= 2
+							|| (count(pieces::Type::Bishop) >= 1 && count(pieces::Type::Knight) >= 1))
+					{
+						entry.Type = hash::EndGame::KXK;
+						return entry;
+					}
+					if (pawns[color] == 0 && onlyMinors && count(pieces::Type::Bishop) == 0)
+					{
+						// Knights alone cannot force mate
+						entry.ScaleFactors[color] = 0;
+						continue;
+					}
+				}
+
+				if (pawns[color] == 0 && nonPawnMaterial[color] - nonPawnMaterial[(int)them] <= MIN_WINNING_EDGE)
+				{
+					entry.ScaleFactors[color] = nonPawnMaterial[color] < PIECE_SCORES[(int)pieces::Type::Rook] ? 0 :
+												nonPawnMaterial[(int)them] <= MIN_WINNING_EDGE ? 4 : 14;
+				}
 			}
 
-			return 0;
+			const auto onlyBishop = [&board](const pieces::Color color)
+			{
+				return board.GetPieceCount(color, pieces::Type::Bishop) == 1
+						&& board.GetPieceCount(color, pieces::Type::Knight) == 0
+						&& board.GetPieceCount(color, pieces::Type::Rook) == 0
+						&& board.GetPieceCount(color, pieces::Type::Queen) == 0;
+			};
+			entry.SingleBishops = onlyBishop(pieces::Color::White) && onlyBishop(pieces::Color::Black);
+
+			return entry;
 		}
 
-		auto EvaluateAlivePieces(const Board& board, const Square* pieceSquares, const pieces::Piece* pieces,
-				const auto count, const auto pawnCount)
+		int GetKingDistance(const Square lhs, const Square rhs)
 		{
-			int score = 0;
-			for (int i = 0; i < count; i++)
-			{
-				const auto type = pieces[i].type();
-				auto pieceScore = PIECE_SCORES[(int)type];
-				pieceScore += GetPieceScoreTweak(board, pieceSquares[i], pieces[i], pawnCount);
-				score += pieces[i].color() == core::pieces::Color::White ? pieceScore : -pieceScore;
-			}
+			return std::max(std::abs(lhs.file() - rhs.file()), std::abs(lhs.rank() - rhs.rank()));
+		}
 
-			return score;
+		int GetCenterDistance(const Square square)
+		{
+			return std::max(3 - square.file(), square.file() - 4) + std::max(3 - square.rank(), square.rank() - 4);
 		}
 
-		auto EvaluatePieceCounts(const Board& board)
+		// Drive the lone king to the edge, or to a corner the bishop controls, and bring the other king close
+		int EvaluateEndGame(const Board& board, const hash::MaterialEntry& material)
 		{
-			int score = 0;
-			if (board.GetPieceCount(core::pieces::Color::White, core::pieces::Type::Bishop) >= 2)
+			if (material.Type == hash::EndGame::Draw)
+			{
+				return 0;
+			}
+
+			const auto strong = material.StrongSide;
+			const auto weakKing = board.GetKingSquare(pieces::OppositeColor(strong));
+			const auto strongKing = board.GetKingSquare(strong);
+
+			const auto& eval = board.eval();
+			const int materialScore = eval.Blend(eval.score()) * (strong == pieces::Color::White ? 1 : -1);
+
+			int score = KNOWN_WIN_SCORE + materialScore + 10 * (BOARD_SIZE - 1 - GetKingDistance(strongKing, weakKing));
+			if (material.Type == hash::EndGame::KXK)
 			{
-				score += board.IsEndGame() ? BISHOP_PAIR_END_GAME_SCORE : BISHOP_PAIR_SCORE;
+				score += 20 * GetCenterDistance(weakKing);
 			}
-			if (board.GetPieceCount(core::pieces::Color::Black, core::pieces::Type::Bishop) >= 2)
+			else
+			{
+				const auto bishopBB = board.GetPieces(strong, pieces::Type::Bishop);
+				auto cornersBB = CORNERS & ((bishopBB & LIGHT_SQUARES) ? LIGHT_SQUARES : ~LIGHT_SQUARES);
+
+				int cornerDistance = BOARD_SIZE;
+				while (cornersBB)
+				{
+					cornerDistance = std::min(cornerDistance, GetKingDistance(weakKing, Square(cornersBB.PopFirstSetBit())));
+				}
+				score += 40 * (BOARD_SIZE - 1 - cornerDistance);
+			}
+
+			return board.colorToPlay() == strong ? score : -score;
+		}
+
+		// White relative score shrunk towards a draw by the side which is ahead
+		int ScaleScore(const Board& board, const hash::MaterialEntry& material, const int score)
+		{
+			const auto strong = score > 0 ? pieces::Color::White : pieces::Color::Black;
+			auto scaleFactor = material.ScaleFactors[(int)strong];
+
+			if (material.SingleBishops)
 			{
-				score -= board.IsEndGame() ? BISHOP_PAIR_END_GAME_SCORE : BISHOP_PAIR_SCORE;
+				const bool whiteOnLight = (bool)(board.GetPieces(pieces::Color::White, pieces::Type::Bishop) & LIGHT_SQUARES);
+				const bool blackOnLight = (bool)(board.GetPieces(pieces::Color::Black, pieces::Type::Bishop) & LIGHT_SQUARES);
+				if (whiteOnLight != blackOnLight)
+				{
+					scaleFactor = std::min(scaleFactor, OPPOSITE_BISHOPS_SCALE);
+				}
 			}
 
-			return score;
+			return score * scaleFactor / hash::MaterialEntry::SCALE_NORMAL;
 		}
 
 		auto EvaluateCheckers(const Board& board)
@@ -162,42 +369,170 @@ namespace chess::ai::eval
 
 			return score;
 		}
+	}
 
-		auto EvaluatePieceSquares(const Board& board)
+	hash::MaterialEntry GetMaterialEntry(const core::Board& board, hash::MaterialTable* materialTable)
+	{
+		std::optional<hash::MaterialEntry> entry;
+		if (materialTable)
 		{
-			const auto& eval = board.eval();
-			return eval.GetScore(core::pieces::Color::White, board.IsEndGame())
-					- eval.GetScore(core::pieces::Color::Black, board.IsEndGame());
+			entry = materialTable->Probe(board.materialHash());
+		}
+
+		if (!entry.has_value())
+		{
+			entry = AnalyzeMaterial(board);
+			if (materialTable)
+			{
+				materialTable->Insert(*entry);
+			}
 		}
+
+		return *entry;
 	}
 
-	int EvaluateBoard(const core::Board& board)
+	int EvaluateBoard(const core::Board& board, const Caches& caches)
 	{
-		Square pieceSquares[32];
-		pieces::Piece pieces[32];
+		bool isLazy;
+		return EvaluateBoard(board, caches, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), isLazy);
+	}
+
+	int EvaluateBoard(const core::Board& board, const Caches& caches, const int alpha, const int beta, bool& isLazy)
+	{
+		isLazy = false;
+
+		// Exact for bitbase endings, the regular terms only tell winning moves apart
+		const auto bitbaseResult = database::bitbase::Probe(board);
+		if (bitbaseResult == database::bitbase::Result::Draw)
+		{
+			return 0;
+		}
+		const int knownResultScore = bitbaseResult == database::bitbase::Result::Win ? KNOWN_WIN_SCORE :
+									 bitbaseResult == database::bitbase::Result::Loss ? -KNOWN_WIN_SCORE : 0;
+
+		if (core::eval::nnue::IsLoaded())
+		{
+			return core::eval::nnue::Evaluate(board.accumulator(), board.colorToPlay()) + knownResultScore;
+		}
 
-		const auto end = board.occupancy().BitScanForwardAll(pieceSquares);
-		const auto count = end - pieceSquares;
-		for (int i = 0; i < count; i++)
+		const auto material = GetMaterialEntry(board, caches.MaterialTable);
+		if (material.Type != hash::EndGame::None)
 		{
-			pieces[i] = board.GetPiece(pieceSquares[i]);
+			return EvaluateEndGame(board, material);
 		}
 
-		const auto pawnCount = board.GetPieces(pieces::Type::Pawn).PopCount();
+		const auto& eval = board.eval();
+		const int sign = board.colorToPlay() == core::pieces::Color::White ? 1 : -1;
 
-		int score = 0;
+		// Material, piece-square values and the phase are kept up to date by the board itself
+		auto taperedScore = eval.score();
+		taperedScore += EvaluatePawnStructure(board, caches.PawnTable);
+		taperedScore += EvaluatePieceCounts(board);
 
-		score += EvaluateAlivePieces(board, pieceSquares, pieces, count, pawnCount);
+		int score = eval.Blend(taperedScore);
+		score += EvaluateMinorPieces(board);
+
+		const auto cheapScore = ScaleScore(board, material, score) * sign + EvaluateCheckers(board) + knownResultScore;
+		if (cheapScore + LAZY_MARGIN <= alpha || cheapScore - LAZY_MARGIN >= beta)
+		{
+			isLazy = true;
+			return cheapScore;
+		}
+
+		score += EvaluateRooks(board, pieces::Color::White) - EvaluateRooks(board, pieces::Color::Black);
 		score += EvaluatePinnedPieces(board);
-		score += EvaluatePieceSquares(board);
-		score += EvaluatePieceCounts(board);
 
-		if (board.colorToPlay() == core::pieces::Color::Black)
+		return ScaleScore(board, material, score) * sign + EvaluateCheckers(board) + knownResultScore;
+	}
+
+	bool IsExchangeAtLeast(const Board& board, const moves::Move move, const int threshold)
+	{
+		const auto start = move.start();
+		const auto end = move.end();
+		const bool isEnPassant = move.type() == moves::Type::EnPassant;
+
+		const auto captured = isEnPassant ? pieces::Type::Pawn : board.GetPiece(end).type();
+		int balance = (board.GetPiece(end).IsValid() || isEnPassant ? PIECE_SCORES[(int)captured] : 0) - threshold;
+		if (balance < 0)
+		{
+			return false;
+		}
+
+		// Even losing the moved piece for nothing keeps the threshold
+		balance = PIECE_SCORES[(int)board.GetPiece(start).type()] - balance;
+		if (balance <= 0)
+		{
+			return true;
+		}
+
+		auto occupancy = board.occupancy().WithReset(start).WithSet(end);
+		if (isEnPassant)
+		{
+			occupancy.ResetAt(moves::GetEnPassantCapturedPawnSquare(move));
+		}
+
+		const auto diagonalSliders = board.GetPieces(pieces::Type::Bishop) | board.GetPieces(pieces::Type::Queen);
+		const auto orthogonalSliders = board.GetPieces(pieces::Type::Rook) | board.GetPieces(pieces::Type::Queen);
+
+		auto attackers =
+				(lookups::GetAttackingPawns(end, pieces::Color::White)
+						& board.GetPieces(pieces::Color::White, pieces::Type::Pawn))
+						| (lookups::GetAttackingPawns(end, pieces::Color::Black)
+								& board.GetPieces(pieces::Color::Black, pieces::Type::Pawn))
+						| (lookups::GetAttackingKnights(end) & board.GetPieces(pieces::Type::Knight))
+						| (lookups::GetKingMoves(end) & board.GetPieces(pieces::Type::King))
+						| (lookups::GetSliderMoves<pieces::Type::Bishop>(end, occupancy) & diagonalSliders)
+						| (lookups::GetSliderMoves<pieces::Type::Rook>(end, occupancy) & orthogonalSliders);
+
+		auto color = board.colorToPlay();
+		// Whether the side that made the move is ahead if the side to move stops capturing
+		bool result = true;
+
+		while (true)
 		{
-			score *= -1;
+			color = pieces::OppositeColor(color);
+			attackers &= occupancy;
+
+			const auto colorAttackers = attackers & board.GetPieces(color);
+			if (!colorAttackers)
+			{
+				break;
+			}
+
+			result = !result;
+
+			int type = (int)pieces::Type::Pawn;
+			while (!(colorAttackers & board.GetPieces((pieces::Type)type)))
+			{
+				type++;
+			}
+
+			// The king can only recapture if nothing is left to take it back
+			if (type == (int)pieces::Type::King)
+			{
+				return (attackers & ~board.GetPieces(color)) ? !result : result;
+			}
+
+			balance = PIECE_SCORES[type] - balance;
+			if (balance < (int)result)
+			{
+				break;
+			}
+
+			occupancy.ResetAt((colorAttackers & board.GetPieces((pieces::Type)type)).BitScanForward());
+
+			// Sliders lined up behind the capturing piece
+			if (type == (int)pieces::Type::Pawn || type == (int)pieces::Type::Bishop
+					|| type == (int)pieces::Type::Queen)
+			{
+				attackers |= lookups::GetSliderMoves<pieces::Type::Bishop>(end, occupancy) & diagonalSliders;
+			}
+			if (type == (int)pieces::Type::Rook || type == (int)pieces::Type::Queen)
+			{
+				attackers |= lookups::GetSliderMoves<pieces::Type::Rook>(end, occupancy) & orthogonalSliders;
+			}
 		}
 
-		score += EvaluateCheckers(board);
-		return score;
+		return result;
 	}
-}
\ No newline at end of file
+}
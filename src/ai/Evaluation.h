@@ -4,6 +4,12 @@
 
 #pragma once
 
+#include <array>
+#include "hash/PawnTable.h"
+#include "hash/MaterialTable.h"
+#include "../core/Common.h"
+#include "../core/moves/Move.h"
+
 namespace chess::core
 {
 	struct Board;
@@ -11,5 +17,29 @@ namespace chess::core
 
 namespace chess::ai::eval
 {
-	int EvaluateBoard(const core::Board& board);
+	constexpr std::array<int, core::pieces::PIECES> PIECE_SCORES{ 100, 290, 310, 515, 900, 0 };
+
+	// Scores at least this high come from recognised won endings, still far below checkmate scores
+	constexpr int KNOWN_WIN_SCORE = 3000;
+
+	// Per-thread caches used by the evaluation, any of them may be missing
+	struct Caches
+	{
+		hash::PawnTable* PawnTable = nullptr;
+		hash::MaterialTable* MaterialTable = nullptr;
+	};
+
+	int EvaluateBoard(const core::Board& board, const Caches& caches = {});
+
+	// Lazy variant: when the cheap terms already lie far outside [alpha, beta] the rest is skipped,
+	// isLazy is set and the result is only good for comparing against the window
+	int EvaluateBoard(const core::Board& board, const Caches& caches, int alpha, int beta, bool& isLazy);
+
+	// Material configuration of the board, probed from the table when given
+	hash::MaterialEntry GetMaterialEntry(const core::Board& board, hash::MaterialTable* materialTable);
+
+	// Static exchange evaluation: whether the sequence of captures on the destination square started by move,
+	// with both sides always recapturing with the least valuable piece, wins at least threshold material.
+	// Sliders behind the capturing pieces join in, pins are ignored
+	NODISCARD bool IsExchangeAtLeast(const core::Board& board, core::moves::Move move, int threshold);
 }
@@ -10,12 +10,38 @@ namespace chess::ai
 {
 	struct SearchParams
 	{
+		// Hard limit in seconds, the whole budget without a clock
 		double MaxTime{};
 		int MaxWorkers{};
 		int TableSize{};
 		int TableBucketSize{};
 		int MaxDepth{};
 		double BookTemperature = 1.0;
+		static constexpr int DEFAULT_REVERSE_FUTILITY_MARGIN = 90;
+		static constexpr int DEFAULT_FUTILITY_MARGIN = 150;
+		static constexpr int DEFAULT_RAZORING_MARGIN = 300;
+
+		// Shallow depth pruning margins in centipawns per ply of remaining depth. Zero or less means the default,
+		// so callers passing a zero-filled struct through the C API do not prune everything
+		int ReverseFutilityMargin = DEFAULT_REVERSE_FUTILITY_MARGIN;
+		int FutilityMargin = DEFAULT_FUTILITY_MARGIN;
+		int RazoringMargin = DEFAULT_RAZORING_MARGIN;
+		// Non-zero switches to the mate solver: a mate in up to this many moves is proven instead of searched.
+		// MaxTime and MaxNodes bound the proof, TableSize is the solver table entry count
+		int MateMoves = 0;
+		int MaxNodes = 0;
+		// Number of best root moves searched each iteration, each with its own line
+		int MultiPv = 1;
+		// Raw moves the root is restricted to, all legal moves when null or none of them is legal
+		const int* SearchMoves = nullptr;
+		int SearchMoveCount = 0;
+		// Clock of the side to move in seconds, none when 0. The time for the move is derived from it
+		double RemainingTime{};
+		double Increment{};
+		// Moves until the next time control, unknown when 0
+		int MovesToGo{};
+		// Seconds lost per move outside the search
+		double MoveOverhead{};
 	};
 
 }
\ No newline at end of file
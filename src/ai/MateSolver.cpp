@@ -0,0 +1,307 @@
+//
+// Created by matvey on 18.10.26.
+//
+
+#include "MateSolver.h"
+
+#include <algorithm>
+
+#include "../core/moves/MoveGeneration.h"
+
+namespace chess::ai
+{
+	using core::moves::Move;
+	using core::moves::MAX_MOVES;
+	using core::moves::GenerateMoves;
+	using core::moves::Legality;
+
+	// Proof and disproof numbers of solved nodes, sums saturate here
+	static constexpr uint32_t INFINITE = 1u << 30;
+	static constexpr size_t BUDGET_CHECK_INTERVAL = 1024;
+
+	// The same position is a different node for every number of remaining plies, which also keeps the graph acyclic
+	static uint64_t GetNodeKey(const uint64_t hash, const int remaining)
+	{
+		return hash ^ (0x9E3779B97F4A7C15ull * (uint64_t)(remaining + 1));
+	}
+
+	static uint32_t AddSaturated(const uint32_t a, const uint32_t b)
+	{
+		return (uint32_t)std::min<uint64_t>((uint64_t)a + b, INFINITE);
+	}
+
+	MateSolver::MateSolver(const int tableSize)
+	{
+		size_t size = 1;
+		while (size * 2 <= (size_t)std::max(1, tableSize))
+		{
+			size *= 2;
+		}
+		m_Table.resize(size);
+	}
+
+	MateSolver::Result MateSolver::Solve(const core::Board& board, const int maxMoves, const double maxTime,
+			const size_t maxNodes)
+	{
+		m_StartTime = std::chrono::steady_clock::now();
+		m_MaxTime = maxTime;
+		m_MaxNodes = maxNodes;
+		m_Nodes = 0;
+		m_Stopped = false;
+		std::fill(m_Table.begin(), m_Table.end(), Entry{});
+
+		auto searchBoard = board.CloneWithoutHistory();
+		Result result;
+
+		// Shortest first, so the first proof gives the mate distance
+		for (int moves = 1; moves <= maxMoves; moves++)
+		{
+			const int remaining = moves * 2 - 1;
+			Expand(searchBoard, remaining, INFINITE, INFINITE);
+			if (m_Stopped)
+			{
+				break;
+			}
+
+			if (Probe(GetNodeKey(searchBoard.hash(), remaining)).Proof == 0)
+			{
+				result.Outcome = Status::Mate;
+				result.MateIn = moves;
+				ExtractLine(searchBoard, remaining, result.Line);
+				break;
+			}
+		}
+
+		if (result.Outcome != Status::Mate && !m_Stopped)
+		{
+			result.Outcome = Status::NoMate;
+		}
+		result.Nodes = m_Nodes;
+		return result;
+	}
+
+	// Numbers are from the attacker's point of view: the attacker needs one proven child, the defender
+	// is disproven by one surviving reply. Odd remaining plies are attacker nodes
+	void MateSolver::Expand(core::Board& board, const int remaining, const uint32_t proofThreshold,
+			const uint32_t disproofThreshold)
+	{
+		if (IsOutOfBudget())
+		{
+			m_Stopped = true;
+			return;
+		}
+		m_Nodes++;
+
+		const auto key = GetNodeKey(board.hash(), remaining);
+		const bool isAttacker = remaining % 2 == 1;
+
+		Move moves[MAX_MOVES];
+		const auto end = GenerateMoves<Legality::Legal>(board, moves);
+		const int count = (int)(end - moves);
+
+		if (count == 0)
+		{
+			// Only a mated defender proves, stalemate or a mated attacker do not
+			if (!isAttacker && board.checkers())
+			{
+				Store(key, 0, INFINITE);
+			}
+			else
+			{
+				Store(key, INFINITE, 0);
+			}
+			return;
+		}
+
+		if (remaining == 0)
+		{
+			// Defender survived the last attacker move
+			Store(key, INFINITE, 0);
+			return;
+		}
+
+		uint64_t childKeys[MAX_MOVES];
+		for (int i = 0; i < count; i++)
+		{
+			board.MakeMove(moves[i]);
+			childKeys[i] = GetNodeKey(board.hash(), remaining - 1);
+			board.UndoMove();
+		}
+
+		while (true)
+		{
+			// The attacker minimizes proof and sums disproof numbers, the defender the other way around.
+			// "Best" is the child with the smallest number the node minimizes
+			int bestIndex = 0;
+			uint32_t best = INFINITE;
+			uint32_t secondBest = INFINITE;
+			uint32_t sum = 0;
+			uint32_t bestOther = 0;
+
+			for (int i = 0; i < count; i++)
+			{
+				const auto entry = Probe(childKeys[i]);
+				const auto minimized = isAttacker ? entry.Proof : entry.Disproof;
+				const auto summed = isAttacker ? entry.Disproof : entry.Proof;
+
+				sum = AddSaturated(sum, summed);
+				if (minimized < best)
+				{
+					secondBest = best;
+					best = minimized;
+					bestIndex = i;
+					bestOther = summed;
+				}
+				else if (minimized < secondBest)
+				{
+					secondBest = minimized;
+				}
+			}
+
+			const auto proof = isAttacker ? best : sum;
+			const auto disproof = isAttacker ? sum : best;
+			if (proof >= proofThreshold || disproof >= disproofThreshold)
+			{
+				Store(key, proof, disproof);
+				return;
+			}
+
+			// The chosen child is searched until it stops being the best or would push the sum over its threshold
+			const auto minimizedThreshold = isAttacker ? proofThreshold : disproofThreshold;
+			const auto summedThreshold = isAttacker ? disproofThreshold : proofThreshold;
+			const auto childMinimizedThreshold = std::min(minimizedThreshold, AddSaturated(secondBest, 1));
+			const auto childSummedThreshold = (uint32_t)std::min<uint64_t>(
+					(uint64_t)summedThreshold - sum + bestOther, INFINITE);
+
+			board.MakeMove(moves[bestIndex]);
+			if (isAttacker)
+			{
+				Expand(board, remaining - 1, childMinimizedThreshold, childSummedThreshold);
+			}
+			else
+			{
+				Expand(board, remaining - 1, childSummedThreshold, childMinimizedThreshold);
+			}
+			board.UndoMove();
+
+			if (m_Stopped)
+			{
+				return;
+			}
+		}
+	}
+
+	// Follows proven children from a proven node. The defender plays the reply with the longest shortest mate,
+	// entries lost to replacement are proven again on the way
+	void MateSolver::ExtractLine(core::Board& board, int remaining, std::vector<Move>& line)
+	{
+		const auto findProvenChild = [this, &board, &remaining](const Move* moves, const int count)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				board.MakeMove(moves[i]);
+				const auto proof = Probe(GetNodeKey(board.hash(), remaining - 1)).Proof;
+				board.UndoMove();
+
+				if (proof == 0)
+				{
+					return i;
+				}
+			}
+			return -1;
+		};
+
+		const auto getShortestMate = [this, &board](const int maxMoves)
+		{
+			for (int moves = 1; moves <= maxMoves && !m_Stopped; moves++)
+			{
+				Expand(board, moves * 2 - 1, INFINITE, INFINITE);
+				if (Probe(GetNodeKey(board.hash(), moves * 2 - 1)).Proof == 0)
+				{
+					return moves;
+				}
+			}
+			return 0;
+		};
+
+		while (remaining > 0 && !m_Stopped)
+		{
+			Move moves[MAX_MOVES];
+			const auto end = GenerateMoves<Legality::Legal>(board, moves);
+			const int count = (int)(end - moves);
+			if (count == 0)
+			{
+				break;
+			}
+
+			int index = -1;
+			int nextRemaining = remaining - 1;
+			if (remaining % 2 == 1)
+			{
+				index = findProvenChild(moves, count);
+				if (index < 0)
+				{
+					Expand(board, remaining, INFINITE, INFINITE);
+					index = findProvenChild(moves, count);
+				}
+			}
+			else
+			{
+				int longestMate = 0;
+				for (int i = 0; i < count; i++)
+				{
+					board.MakeMove(moves[i]);
+					const auto mateMoves = getShortestMate(remaining / 2);
+					board.UndoMove();
+
+					if (mateMoves > longestMate)
+					{
+						longestMate = mateMoves;
+						index = i;
+					}
+				}
+				nextRemaining = longestMate * 2 - 1;
+			}
+
+			if (index < 0 || m_Stopped)
+			{
+				break;
+			}
+
+			line.push_back(moves[index]);
+			board.MakeMove(moves[index]);
+			remaining = nextRemaining;
+		}
+
+		for (size_t i = 0; i < line.size(); i++)
+		{
+			board.UndoMove();
+		}
+	}
+
+	void MateSolver::Store(const uint64_t key, const uint32_t proof, const uint32_t disproof)
+	{
+		m_Table[key & (m_Table.size() - 1)] = { key, proof, disproof };
+	}
+
+	MateSolver::Entry MateSolver::Probe(const uint64_t key) const
+	{
+		const auto& entry = m_Table[key & (m_Table.size() - 1)];
+		return entry.Key == key ? entry : Entry{};
+	}
+
+	bool MateSolver::IsOutOfBudget()
+	{
+		if (m_Stopped || (m_MaxNodes && m_Nodes >= m_MaxNodes))
+		{
+			return true;
+		}
+
+		if (m_MaxTime > 0 && m_Nodes % BUDGET_CHECK_INTERVAL == 0)
+		{
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_StartTime;
+			return elapsed.count() >= m_MaxTime;
+		}
+		return false;
+	}
+}
@@ -0,0 +1,67 @@
+//
+// Created by matvey on 18.10.26.
+//
+
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+#include "../core/Board.h"
+#include "../core/moves/Move.h"
+
+namespace chess::ai
+{
+	// Proves forced mates for the side to move with depth-first proof-number search. Each node keeps
+	// a proof and a disproof number, the most proving child is expanded until the root is solved
+	// or the node and time budget runs out
+	class MateSolver
+	{
+	public:
+		static constexpr int DEFAULT_TABLE_SIZE = 1 << 20;
+
+		enum struct Status
+		{
+			Mate,
+			NoMate,
+			Unknown
+		};
+
+		struct Result
+		{
+			Status Outcome = Status::Unknown;
+			// Moves of the side to move, shortest proven mate
+			int MateIn = 0;
+			// Attacker and defender moves ending in mate, against the longest defence
+			std::vector<core::moves::Move> Line;
+			size_t Nodes = 0;
+		};
+
+		explicit MateSolver(int tableSize = DEFAULT_TABLE_SIZE);
+
+		// Mates in up to maxMoves moves are tried shortest first. Zero maxTime or maxNodes means no limit
+		NODISCARD Result Solve(const core::Board& board, int maxMoves, double maxTime = 0, size_t maxNodes = 0);
+
+	private:
+		struct Entry
+		{
+			uint64_t Key = 0;
+			uint32_t Proof = 1;
+			uint32_t Disproof = 1;
+		};
+
+		void Expand(core::Board& board, int remaining, uint32_t proofThreshold, uint32_t disproofThreshold);
+		void Store(uint64_t key, uint32_t proof, uint32_t disproof);
+		void ExtractLine(core::Board& board, int remaining, std::vector<core::moves::Move>& line);
+		NODISCARD Entry Probe(uint64_t key) const;
+		NODISCARD bool IsOutOfBudget();
+
+		std::vector<Entry> m_Table;
+		std::chrono::time_point<std::chrono::steady_clock> m_StartTime;
+		double m_MaxTime = 0;
+		size_t m_MaxNodes = 0;
+		size_t m_Nodes = 0;
+		bool m_Stopped = false;
+	};
+}
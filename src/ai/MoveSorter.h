@@ -6,9 +6,13 @@
 
 #include "../core/moves/Move.h"
 #include "../core/moves/MoveGeneration.h"
+#include "Evaluation.h"
 
 #include <limits>
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cstdlib>
 
 namespace chess::ai::details
 {
@@ -23,6 +27,10 @@ namespace chess::ai::details
 
 	static constexpr int MVV_LVA_OFFSET = 2'000'000;
 	static constexpr int KILLER_MOVE_OFFSET = 1'000'000;
+	// Captures losing material by static exchange go after killers, still before quiet moves
+	static constexpr int BAD_CAPTURE_OFFSET = 500'000;
+	// Quiet moves are ordered by history, which stays within +-MAX_HISTORY
+	static constexpr int MAX_HISTORY = 16'384;
 	static constexpr int TT_MOVE_VALUE = MVV_LVA_OFFSET + 100;
 
 	struct ScoredMove : core::moves::TypedMove
@@ -34,6 +42,17 @@ namespace chess::ai::details
 		{
 		}
 
+		NODISCARD constexpr bool IsBadCapture() const
+		{
+			return IsCapture() && BAD_CAPTURE_OFFSET <= Score && Score < KILLER_MOVE_OFFSET;
+		}
+
+		// Neither a capture nor a promotion
+		NODISCARD constexpr bool IsQuiet() const
+		{
+			return type() <= core::moves::Type::ShortCastle;
+		}
+
 		int Score{};
 	};
 
@@ -41,13 +60,13 @@ namespace chess::ai::details
 	class MoveSorter
 	{
 	public:
-		void Populate(const core::moves::TypedMove* start,
+		void Populate(const core::Board& board, const core::moves::TypedMove* start,
 				const core::moves::TypedMove* end, ScoredMove* output,
 				const int ply, const core::moves::Move ttMove)
 		{
 			for (auto it = start; it != end; it++)
 			{
-				*output++ = ScoreMove(*it, ply, ttMove);
+				*output++ = ScoreMove(board, *it, ply, ttMove);
 			}
 		}
 
@@ -99,8 +118,35 @@ namespace chess::ai::details
 				*lowestScoreMove = move;
 			}
 		}
+		NODISCARD int GetHistory(const core::moves::TypedMove& move) const
+		{
+			return m_History[GetHistoryIndex(move)].load(std::memory_order_relaxed);
+		}
+
+		// Moves causing cutoffs get a bonus, quiet moves tried before them the same malus.
+		// Updates shrink as the value approaches MAX_HISTORY
+		void UpdateHistory(const core::moves::TypedMove& move, const int bonus)
+		{
+			auto& entry = m_History[GetHistoryIndex(move)];
+			const int value = entry.load(std::memory_order_relaxed);
+			entry.store(value + bonus - value * std::abs(bonus) / MAX_HISTORY, std::memory_order_relaxed);
+		}
+
+		void Reset()
+		{
+			std::scoped_lock lock(m_Mutex);
+
+			for (auto& killers : m_KillerMoves)
+			{
+				std::fill(killers, killers + MaxKillerMovePerPly, ScoredMove());
+			}
+			for (auto& entry : m_History)
+			{
+				entry.store(0, std::memory_order_relaxed);
+			}
+		}
 	private:
-		NODISCARD ScoredMove ScoreMove(const core::moves::TypedMove& move,
+		NODISCARD ScoredMove ScoreMove(const core::Board& board, const core::moves::TypedMove& move,
 				const int ply, const core::moves::Move ttMove)
 		{
 			int score = 0;
@@ -112,18 +158,32 @@ namespace chess::ai::details
 			{
 				const int attacking = (int)move.movedPiece().type();
 				const int victim = (int)move.capturedPiece().type();
-				score = MVV_LVA_OFFSET + MVV_LVA[victim][attacking];
+				// Taking a more valuable piece can never lose material
+				const bool isGood = victim >= attacking || eval::IsExchangeAtLeast(board, move, 0);
+				score = (isGood ? MVV_LVA_OFFSET : BAD_CAPTURE_OFFSET) + MVV_LVA[victim][attacking];
 			}
 			else if (IsKillerMove(move, ply))
 			{
 				score = KILLER_MOVE_OFFSET;
 			}
+			else if (move.type() <= core::moves::Type::ShortCastle)
+			{
+				score = GetHistory(move);
+			}
 
 			score += (int)move.type();
 			return { move, score }; // NOLINT(cppcoreguidelines-slicing)
 		}
 
+		NODISCARD static int GetHistoryIndex(const core::moves::TypedMove& move)
+		{
+			return ((int)move.movedPiece().color() * core::BOARD_SQUARES + move.start().value()) * core::BOARD_SQUARES
+					+ move.end().value();
+		}
+
 		std::mutex m_Mutex;
 		ScoredMove m_KillerMoves[MaxPly][MaxKillerMovePerPly];
+		// Shared by all search threads, updated without locking
+		std::array<std::atomic_int, core::pieces::COLORS * core::BOARD_SQUARES * core::BOARD_SQUARES> m_History{};
 	};
 }
\ No newline at end of file
@@ -0,0 +1,138 @@
+//
+// Created by matvey on 18.10.26.
+//
+
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include "../core/Board.h"
+#include "../core/moves/Move.h"
+#include "../core/moves/MoveGeneration.h"
+
+namespace chess::ai::details
+{
+	struct RootMove
+	{
+		core::moves::Move Move;
+		// Of the current iteration, only for moves that raised alpha
+		int Score = std::numeric_limits<int>::min();
+		// Subtree size in the current iteration
+		size_t Nodes = 0;
+	};
+
+	// Moves searched at the root. After every completed iteration the best move goes first and the rest
+	// follow by subtree size, the moves that were hardest to refute
+	class RootMoves
+	{
+	public:
+		// Legal moves, restricted to searchMoves when any of them is legal
+		void Reset(const core::Board& board, const int* searchMoves = nullptr, const int searchMoveCount = 0)
+		{
+			core::moves::Move moves[core::moves::MAX_MOVES];
+			const auto end = core::moves::GenerateMoves<core::moves::Legality::Legal>(board, moves);
+
+			m_Moves.clear();
+			for (auto it = moves; it != end; ++it)
+			{
+				if (!searchMoves || std::find(searchMoves, searchMoves + searchMoveCount, it->value())
+						!= searchMoves + searchMoveCount)
+				{
+					m_Moves.push_back({ .Move = *it });
+				}
+			}
+
+			if (m_Moves.empty() && searchMoves)
+			{
+				Reset(board);
+				return;
+			}
+			m_IsOrdered = false;
+		}
+
+		// Before an iteration
+		void ResetNodes()
+		{
+			for (auto& rootMove: m_Moves)
+			{
+				rootMove.Nodes = 0;
+			}
+		}
+
+		// Before a root search, the moves of better MultiPV lines keep their scores
+		void ResetScores(const std::vector<core::moves::Move>& keptMoves)
+		{
+			for (auto& rootMove: m_Moves)
+			{
+				if (std::find(keptMoves.begin(), keptMoves.end(), rootMove.Move) == keptMoves.end())
+				{
+					rootMove.Score = std::numeric_limits<int>::min();
+				}
+			}
+		}
+
+		void Update(const core::moves::Move move, const int score, const size_t nodes)
+		{
+			const auto rootMove = std::find_if(m_Moves.begin(), m_Moves.end(), [move](const RootMove& rootMove)
+			{
+				return rootMove.Move == move;
+			});
+			if (rootMove != m_Moves.end())
+			{
+				rootMove->Score = score;
+				rootMove->Nodes += nodes;
+			}
+		}
+
+		// After a completed iteration
+		void Sort()
+		{
+			std::stable_sort(m_Moves.begin(), m_Moves.end(), [](const RootMove& a, const RootMove& b)
+			{
+				return a.Score != b.Score ? a.Score > b.Score : a.Nodes > b.Nodes;
+			});
+			m_IsOrdered = true;
+		}
+
+		// Position in the order, -1 for moves not searched at the root
+		NODISCARD int GetRank(const core::moves::Move move) const
+		{
+			for (int i = 0; i < (int)m_Moves.size(); i++)
+			{
+				if (m_Moves[i].Move == move)
+				{
+					return i;
+				}
+			}
+			return -1;
+		}
+
+		// Share of the iteration's root nodes spent on the best move
+		NODISCARD double GetBestMoveNodeFraction() const
+		{
+			size_t total = 0;
+			for (const auto& rootMove: m_Moves)
+			{
+				total += rootMove.Nodes;
+			}
+			return total == 0 || m_Moves.empty() ? 0 : (double)m_Moves.front().Nodes / (double)total;
+		}
+
+		// False until an iteration has completed
+		NODISCARD bool isOrdered() const
+		{
+			return m_IsOrdered;
+		}
+
+		NODISCARD int size() const
+		{
+			return (int)m_Moves.size();
+		}
+
+	private:
+		std::vector<RootMove> m_Moves;
+		bool m_IsOrdered = false;
+	};
+}
@@ -12,11 +12,18 @@
 #include <list>
 #include <deque>
 #include <cstring>
+#include <cmath>
 #include "Search.h"
 #include "Evaluation.h"
 #include "Defs.h"
+#include "MateSolver.h"
+#include "RootMoves.h"
+#include "TimeManager.h"
 #include "../core/Fen.h"
 #include "../core/Misc.h"
+#include "../core/Lookups.h"
+#include "../database/Bitbase.h"
+#include "../database/Syzygy.h"
 
 namespace chess::ai::details
 {
@@ -25,9 +32,86 @@ namespace chess::ai::details
 	static constexpr int CHECKMATE_THRESHOLD = 9500;
 	static constexpr int CHECKMATE_SCORE = -10000;
 	static constexpr int STALEMATE_SCORE = 0;
+	// Below mate scores, above anything the evaluation returns
+	static constexpr int TABLEBASE_WIN_SCORE = 9000;
+
+	// Reverse futility, futility and razoring, margins come from the search params
+	static constexpr int SHALLOW_PRUNING_DEPTH = 3;
+
+	// Late move reductions grow with log(depth) * log(move number)
+	static constexpr int LMR_MIN_DEPTH = 3;
+	static constexpr int LMR_TABLE_SIZE = 64;
+	static constexpr double LMR_BASE = 0.75;
+	static constexpr double LMR_DIVISOR = 2.25;
+	// One ply less or more reduction per this much history
+	static constexpr int LMR_HISTORY_DIVISOR = 8192;
+	static constexpr int MAX_HISTORY_BONUS = 1200;
+
+	// Late move pruning keeps LMP_BASE_MOVES + depth^2 moves
+	static constexpr int LMP_MAX_DEPTH = 6;
+	static constexpr int LMP_BASE_MOVES = 3;
+
+	// Without a hash move, PV nodes search shallower first to find one, other nodes are searched a ply shallower
+	static constexpr int IID_MIN_DEPTH = 5;
+	static constexpr int IID_REDUCTION = 2;
+	static constexpr int IIR_MIN_DEPTH = 4;
+
+	// Singular extensions: the hash move is extended when every other move fails low against
+	// its lower bound minus the margin, at half the depth
+	static constexpr int SINGULAR_MIN_DEPTH = 8;
+	static constexpr int SINGULAR_TT_DEPTH_MARGIN = 3;
+	static constexpr int SINGULAR_MARGIN = 2;
+
+	// ProbCut: a capture beating beta by the margin in a reduced search most likely beats beta in a full one.
+	// Below the min depth the reduced search would be a quiescence search, blind to quiet mates
+	static constexpr int PROBCUT_MIN_DEPTH = 6;
+	static constexpr int PROBCUT_MARGIN = 200;
+	static constexpr int PROBCUT_REDUCTION = 4;
+
+	// Delta pruning: captures that can not bring the stand pat within this margin of alpha are skipped
+	static constexpr int DELTA_MARGIN = 400;
+
+	static constexpr int NULL_MOVE_MIN_DEPTH = 2;
+	static constexpr int NULL_MOVE_REDUCTION = 3;
+	// Extra reduction per this much static eval above beta, up to the max
+	static constexpr int NULL_MOVE_EVAL_MARGIN = 200;
+	static constexpr int NULL_MOVE_MAX_EVAL_REDUCTION = 3;
+	static constexpr int NULL_MOVE_VERIFICATION_DEPTH = 12;
 
 	namespace
 	{
+		const auto s_Reductions = []
+		{
+			std::array<std::array<int, LMR_TABLE_SIZE>, LMR_TABLE_SIZE> reductions{};
+			for (int depth = 1; depth < LMR_TABLE_SIZE; depth++)
+			{
+				for (int moveNumber = 1; moveNumber < LMR_TABLE_SIZE; moveNumber++)
+				{
+					reductions[depth][moveNumber] =
+							(int)(LMR_BASE + std::log(depth) * std::log(moveNumber) / LMR_DIVISOR);
+				}
+			}
+			return reductions;
+		}();
+
+		// Margins of zero or less fall back to the defaults
+		SearchParams WithDefaultMargins(SearchParams params)
+		{
+			if (params.ReverseFutilityMargin <= 0)
+			{
+				params.ReverseFutilityMargin = SearchParams::DEFAULT_REVERSE_FUTILITY_MARGIN;
+			}
+			if (params.FutilityMargin <= 0)
+			{
+				params.FutilityMargin = SearchParams::DEFAULT_FUTILITY_MARGIN;
+			}
+			if (params.RazoringMargin <= 0)
+			{
+				params.RazoringMargin = SearchParams::DEFAULT_RAZORING_MARGIN;
+			}
+			return params;
+		}
+
 		int ApplyCheckmateCorrection(const int score, const int ply)
 		{
 			if (score > CHECKMATE_THRESHOLD)
@@ -44,8 +128,9 @@ namespace chess::ai::details
 
 	struct SharedData
 	{
-		explicit SharedData(const std::function<void(int, const Move*, int)>* hook)
-				:m_Hook(hook)
+		explicit SharedData(const std::function<void(int, const Move*, int)>* hook,
+				const SearchResultHook* resultHook = nullptr)
+				:m_Hook(hook), m_ResultHook(resultHook)
 		{
 		}
 
@@ -66,6 +151,16 @@ namespace chess::ai::details
 			m_Hook->operator()(m_MaxReachedDepth, pvBegin, pvCount);
 		}
 
+		void InvokeResultHook(const SearchResult& result)
+		{
+			if (!m_ResultHook)
+			{
+				return;
+			}
+			std::scoped_lock lock(m_Mutex);
+			m_ResultHook->operator()(result);
+		}
+
 		NODISCARD int GetHighestDepth() const
 		{
 			return m_MaxReachedDepth;
@@ -73,6 +168,7 @@ namespace chess::ai::details
 
 	private:
 		const std::function<void(int, const Move*, int)>* m_Hook;
+		const SearchResultHook* m_ResultHook;
 		int m_MaxReachedDepth = 0;
 
 		std::mutex m_Mutex;
@@ -81,10 +177,18 @@ namespace chess::ai::details
 	struct Thread
 	{
 		explicit Thread(const core::Board& board, hash::TranspositionTable& transpositionTable,
-				MoveSorter<MAX_PLY>& moveSorter, SharedData& sharedData)
+				MoveSorter<MAX_PLY>& moveSorter, SharedData& sharedData, const SearchParams& searchParams = {})
 				:Table{ transpositionTable }, Sorter{ moveSorter },
-				 Board{ board.CloneWithoutHistory() }, m_SharedData{ sharedData }
+				 Board{ board.CloneWithoutHistory() }, m_SharedData{ sharedData }, m_Params{ WithDefaultMargins(searchParams) }
+		{
+			m_RootMoves.Reset(Board, m_Params.SearchMoves, m_Params.SearchMoveCount);
+		}
+
+		// Starts over from a new root position
+		void SetRoot(const core::Board& board)
 		{
+			Board = board.CloneWithoutHistory();
+			m_RootMoves.Reset(Board, m_Params.SearchMoves, m_Params.SearchMoveCount);
 		}
 
 		void Search(const bool isMain, const int depth, const bool verbose)
@@ -93,23 +197,130 @@ namespace chess::ai::details
 
 			m_Ready = false;
 			Depth = depth;
+			m_RootPieces = Board.occupancy().PopCount();
+			m_RootMoves.ResetNodes();
+
+			const int lineCount = std::clamp(m_Params.MultiPv, 1, std::max(1, m_RootMoves.size()));
+
+			// MultiPV: every next line is searched with the root moves of the previous ones excluded
+			std::vector<SearchResult> lines;
+			m_ExcludedRootMoves.clear();
+			for (int line = 0; line < lineCount; line++)
+			{
+				const int lastScore = line < (int)m_LastLines.size() ? m_LastLines[line].Score : m_LastBestScore;
+				const int score = AspirationSearch(depth, lastScore);
+				if (ShouldStop())
+				{
+					m_ExcludedRootMoves.clear();
+					m_Ready = true;
+					return;
+				}
+
+				lines.push_back({ .Depth = depth, .SelDepth = Stats.SelDepth, .Score = score, .Nodes = Stats.Nodes,
+						.PV = std::vector<Move>(PV[0].begin(), PV[0].begin() + PVLength[0]) });
+
+				if (PVLength[0] == 0)
+				{
+					break;
+				}
+				m_ExcludedRootMoves.push_back(PV[0][0]);
+			}
+			m_ExcludedRootMoves.clear();
 
+			// Later lines may still score higher, the windows of the earlier ones did not include them
+			std::stable_sort(lines.begin(), lines.end(), [](const SearchResult& a, const SearchResult& b)
+			{
+				return a.Score > b.Score;
+			});
+			for (int i = 0; i < (int)lines.size(); i++)
+			{
+				lines[i].MultiPvIndex = i;
+			}
+
+			m_LastLines = lines;
+			m_LastBestScore = lines[0].Score;
+			m_RootMoves.Sort();
+			m_BestMoveNodeFraction = m_RootMoves.GetBestMoveNodeFraction();
+			m_CompletedDepth = depth;
+
+			if (!m_SharedData.IsHighestCompletedDepth(depth))
+			{
+				m_Ready = true;
+				return;
+			}
+
+			m_SharedData.InvokeHook(lines[0].PV.data(), (int)lines[0].PV.size());
+			for (const auto& line: lines)
+			{
+				m_SharedData.InvokeResultHook(line);
+			}
+
+			if (verbose)
+			{
+				const auto hitRate = [](const auto& table)
+				{
+					return table.probes() == 0 ? 0 : (int)(100 * table.hits() / table.probes());
+				};
+
+				for (const auto& line: lines)
+				{
+					std::cout << "Info: depth " << depth;
+					if (lines.size() > 1)
+					{
+						std::cout << " multipv " << line.MultiPvIndex + 1;
+					}
+					std::cout << " score " << line.Score << " pv ";
+
+					for (const auto move: line.PV)
+					{
+						std::cout << core::misc::MoveToString(move) << ' ';
+					}
+					if (line.MultiPvIndex > 0)
+					{
+						std::cout << '\n';
+						continue;
+					}
+
+					std::cout << "nodes " << Stats.Nodes <<
+							  " seldepth " << Stats.SelDepth <<
+							  " tthits " << Stats.TTHits <<
+							  " pawnhits " << hitRate(PawnTable) << '%' <<
+							  " evalhits " << hitRate(EvalTable) << '%' <<
+							  " lazyskips " << (Stats.LazyEvals == 0 ? 0 : (int)(100 * Stats.LazySkips / Stats.LazyEvals)) << '%'
+							  << " bbhits " << Stats.BitbaseHits
+							  << " tbhits " << Stats.TablebaseHits
+							  << " nullcuts " << Stats.NullMoveCuts
+							  << " iid " << Stats.IidImprovements << '/' << Stats.IidSearches
+							  << " singular " << Stats.SingularExtensions
+							  << " multicuts " << Stats.MultiCuts
+							  << " probcuts " << Stats.ProbCuts
+							  << " deltaprunes " << Stats.DeltaPrunes
+							  << " upcomingreps " << Stats.UpcomingRepetitions
+							  << (isMain ? " mainthread" : "") << '\n';
+				}
+			}
+
+			m_Ready = true;
+		}
+
+		// Root search with a window around the last score, widened until the score falls inside
+		int AspirationSearch(const int depth, const int lastScore)
+		{
 			static constexpr int SEARCH_MIN = -100'000, SEARCH_MAX = 100'000;
 
 			int alpha = SEARCH_MIN;
 			int beta = SEARCH_MAX;
-			int score;
+			int score = 0;
 
 			static constexpr int INIT_ASP_WINDOW = 25;
 			int window = INIT_ASP_WINDOW;
 
 			if (depth >= 5)
 			{
-				beta = m_LastBestScore + window;
-				alpha = m_LastBestScore - window;
+				beta = lastScore + window;
+				alpha = lastScore - window;
 			}
 
-			// Aspiration window search
 			while (!ShouldStop())
 			{
 				score = AlphaBeta<Node::PV>(depth, alpha, beta);
@@ -130,36 +341,7 @@ namespace chess::ai::details
 				window += window / 3 + 5;
 			}
 
-			if (ShouldStop())
-			{
-				m_Ready = true;
-				return;
-			}
-
-			m_LastBestScore = score;
-
-			if (!m_SharedData.IsHighestCompletedDepth(depth))
-			{
-				m_Ready = true;
-				return;
-			}
-
-			m_SharedData.InvokeHook(PV[0].begin(), PVLength[0]);
-
-			if (verbose)
-			{
-				std::cout << "Info: depth " << depth << " score " << score << " pv ";
-
-				for (int i = 0; i < PVLength[0]; i++)
-				{
-					std::cout << core::misc::MoveToString(PV[0][i]) << ' ';
-				}
-				std::cout << "nodes " << Stats.Nodes <<
-						  " seldepth " << Stats.SelDepth <<
-						  " tthits " << Stats.TTHits << (isMain ? " mainthread" : "") << '\n';
-			}
-
-			m_Ready = true;
+			return score;
 		}
 
 		template<Node NodeType>
@@ -186,9 +368,71 @@ namespace chess::ai::details
 				return STALEMATE_SCORE;
 			}
 
+			// The side to move can repeat a position, the node is worth at least a draw
+			if (Ply > 0 && alpha < STALEMATE_SCORE && Board.HasUpcomingRepetition())
+			{
+				Stats.UpcomingRepetitions++;
+				alpha = STALEMATE_SCORE;
+				if (alpha >= beta)
+				{
+					return alpha;
+				}
+			}
+
+			// Neither side can mate, nothing to search
+			if (Ply > 0 && eval::GetMaterialEntry(Board, &MaterialTable).Type == hash::EndGame::Draw)
+			{
+				return STALEMATE_SCORE;
+			}
+
+			// Reset before anything evaluates, the entry still holds the last node searched at this ply
+			Stack[Ply].StaticEval = hash::NO_STATIC_EVAL;
+			Stack[Ply].IsNullMove = false;
+			Stack[Ply].BestMove = Move::Empty();
+
+			// Bitbase endings are cut off when reached from a bigger position. If the root is one already,
+			// only draws are, so the search can still find the way to mate
+			const int bitbasePieces = database::bitbase::GetMaxPieces();
+			if (Ply > 0 && Board.occupancy().PopCount() <= bitbasePieces)
+			{
+				const auto result = database::bitbase::Probe(Board);
+				if (result == database::bitbase::Result::Draw)
+				{
+					Stats.BitbaseHits++;
+					return STALEMATE_SCORE;
+				}
+				if (result != database::bitbase::Result::Unknown && m_RootPieces > bitbasePieces
+						&& HasLegalMove(Board))
+				{
+					Stats.BitbaseHits++;
+					return GetStaticEval();
+				}
+			}
+
+			// Syzygy WDL only holds with a fresh fifty move counter and without castling rights.
+			// Closer wins score higher
+			if (Ply > 0 && Board.halfMoves() == 0 && Board.castlingRights().value() == 0
+					&& Board.occupancy().PopCount() <= database::syzygy::GetMaxPieces())
+			{
+				const auto wdl = database::syzygy::ProbeWdl(Board);
+				if (wdl != database::syzygy::Wdl::Unknown)
+				{
+					Stats.TablebaseHits++;
+					switch (wdl)
+					{
+					case database::syzygy::Wdl::Win:
+						return TABLEBASE_WIN_SCORE - Ply;
+					case database::syzygy::Wdl::Loss:
+						return -TABLEBASE_WIN_SCORE + Ply;
+					default:
+						return STALEMATE_SCORE;
+					}
+				}
+			}
+
 			if (Ply >= MAX_PLY)
 			{
-				return eval::EvaluateBoard(Board);
+				return GetStaticEval();
 			}
 
 			auto entryType = hash::EntryType::Alpha;
@@ -196,14 +440,32 @@ namespace chess::ai::details
 
 			const bool isRootNode = Ply == 0;
 
-			if (!isRootNode)
+			// Set by the parent for an exclusion search of this node, which must not use the table:
+			// its result does not hold for the position
+			const Move excludedMove = Stack[Ply].ExcludedMove;
+			const bool isExclusionSearch = excludedMove.IsValid();
+			// Root moves of better MultiPV lines, the best move found is not the root's best move
+			const bool hasExcludedRootMoves = isRootNode && !m_ExcludedRootMoves.empty();
+
+			// The root only takes the previous iteration's best move for ordering
+			if (!isExclusionSearch)
 			{
 				ttEntry = Table.Probe(Board.hash());
-				if (ttEntry.has_value() && !Board.IsLegal(ttEntry->BestMove))
-				{
-					ttEntry.reset();
-				}
-				if (ttEntry.has_value() && !ttEntry->FromQuiescence)
+			}
+			// Fail-low entries carry no move, their bounds and static eval still hold. A move that is not legal
+			// here is dropped on its own
+			if (ttEntry.has_value() && ttEntry->BestMove.IsValid() && !Board.IsLegal(ttEntry->BestMove))
+			{
+				ttEntry->BestMove = Move::Empty();
+			}
+			if (ttEntry.has_value())
+			{
+				Stack[Ply].StaticEval = ttEntry->StaticEval;
+			}
+			if (!isRootNode)
+			{
+				// Quiescence results are as good as a search at the horizon
+				if (ttEntry.has_value() && (!ttEntry->FromQuiescence || depth <= 0))
 				{
 					const auto hitType = ttEntry->Apply(depth, alpha, beta);
 					if (hitType != hash::EntryType::None)
@@ -217,9 +479,38 @@ namespace chess::ai::details
 				}
 			}
 
-			if (NodeType == Node::PV && Ply > 2 && !ttEntry.has_value())
+			Move hashMove = ttEntry.has_value() ? ttEntry->BestMove : Move::Empty();
+			bool isIidMove = false;
+
+			if (!hashMove.IsValid() && !startedInCheck && !isExclusionSearch)
 			{
-				depth -= 2;
+				// The root orders its moves through RootMoves instead
+				if (NodeType == Node::PV && depth >= IID_MIN_DEPTH && !isRootNode)
+				{
+					// Internal iterative deepening: a shallower search of this node finds the move to try first.
+					// Read from the stack, the table may keep a deeper entry instead
+					Stats.IidSearches++;
+					AlphaBeta<Node::PV>(depth - IID_REDUCTION, alpha, beta);
+					if (ShouldStop())
+					{
+						return 0;
+					}
+
+					if (Stack[Ply].BestMove.IsValid())
+					{
+						hashMove = Stack[Ply].BestMove;
+						isIidMove = true;
+					}
+				}
+				else if (NodeType == Node::PV && !isRootNode)
+				{
+					depth -= IID_REDUCTION;
+				}
+				else if (NodeType == Node::NonPV && depth >= IIR_MIN_DEPTH)
+				{
+					// Internal iterative reduction: a node worth searching will have a hash move next time
+					depth--;
+				}
 			}
 
 			if (depth <= 0)
@@ -227,6 +518,147 @@ namespace chess::ai::details
 				return Quiescence(depth, alpha, beta);
 			}
 
+			// Close to the horizon, a static eval far outside the window is trusted
+			const bool canPruneShallow = NodeType == Node::NonPV && !startedInCheck && !isExclusionSearch
+					&& depth <= SHALLOW_PRUNING_DEPTH
+					&& std::abs(alpha) < CHECKMATE_THRESHOLD && std::abs(beta) < CHECKMATE_THRESHOLD;
+			if (canPruneShallow)
+			{
+				const int staticEval = GetStaticEval();
+
+				// Reverse futility: too far above beta for the opponent to catch up
+				const int reverseFutilityScore = staticEval - m_Params.ReverseFutilityMargin * depth;
+				if (reverseFutilityScore >= beta)
+				{
+					return reverseFutilityScore;
+				}
+
+				// Razoring: too far below alpha, only captures are worth checking
+				if (staticEval + m_Params.RazoringMargin * depth < alpha)
+				{
+					const int score = Quiescence(0, alpha, beta);
+					if (score <= alpha)
+					{
+						return score;
+					}
+				}
+			}
+
+			// Null move pruning: if passing still fails high, some real move would as well.
+			// Never twice in a row, in check or close to mate scores
+			if (NodeType == Node::NonPV && !startedInCheck && !isExclusionSearch && depth >= NULL_MOVE_MIN_DEPTH
+					&& Ply >= m_NullMoveMinPly && !Stack[Ply - 1].IsNullMove && std::abs(beta) < CHECKMATE_THRESHOLD)
+			{
+				const int staticEval = GetStaticEval();
+				if (staticEval >= beta)
+				{
+					const auto us = Board.colorToPlay();
+					const bool isPawnEnding = !(Board.GetPieces(us) & ~Board.GetPieces(core::pieces::Type::Pawn)
+							& ~Board.GetPieces(core::pieces::Type::King));
+					const int reduction = NULL_MOVE_REDUCTION + depth / 4
+							+ std::min((staticEval - beta) / NULL_MOVE_EVAL_MARGIN, NULL_MOVE_MAX_EVAL_REDUCTION);
+
+					Stack[Ply].IsNullMove = true;
+					Ply++;
+					Board.MakeNullMove();
+					const int score = -AlphaBeta<Node::NonPV>(depth - reduction - 1, -beta, -beta + 1);
+					Board.UndoNullMove();
+					Ply--;
+					Stack[Ply].IsNullMove = false;
+
+					if (score >= beta)
+					{
+						// Zugzwang is common with pawns only, and deep cutoffs are costly to get wrong:
+						// confirm with a reduced search that may not pass the turn for a while
+						if (!isPawnEnding && depth < NULL_MOVE_VERIFICATION_DEPTH)
+						{
+							Stats.NullMoveCuts++;
+							return beta;
+						}
+
+						const int previousMinPly = m_NullMoveMinPly;
+						m_NullMoveMinPly = Ply + 3 * (depth - reduction) / 4;
+						const int verification = AlphaBeta<Node::NonPV>(depth - reduction, beta - 1, beta);
+						m_NullMoveMinPly = previousMinPly;
+
+						if (verification >= beta)
+						{
+							Stats.NullMoveCuts++;
+							return beta;
+						}
+					}
+				}
+			}
+
+			if (NodeType == Node::NonPV && !startedInCheck && !isExclusionSearch && depth >= PROBCUT_MIN_DEPTH
+					&& std::abs(beta) < CHECKMATE_THRESHOLD)
+			{
+				const int probCutBeta = beta + PROBCUT_MARGIN;
+				const int probCutDepth = depth - PROBCUT_REDUCTION;
+
+				// Not worth it when the table already says the captures fall short
+				const bool isRefuted = ttEntry.has_value() && ttEntry->Depth >= probCutDepth
+						&& ttEntry->Type != hash::EntryType::Beta && ttEntry->Value < probCutBeta;
+				if (!isRefuted)
+				{
+					ScoredMove captures[MAX_MOVES];
+
+					int captureCount;
+					{
+						TypedMove typedMoves[MAX_MOVES];
+						const auto end = GenerateMoves<core::moves::Legality::PseudoLegal, true>(Board, typedMoves);
+						captureCount = (int)(end - typedMoves);
+						Sorter.Populate(Board, typedMoves, end, captures, Ply, hashMove);
+					}
+
+					// Captures have to win at least enough material to make up for the static eval
+					const int exchangeThreshold = std::max(0, probCutBeta - GetStaticEval());
+
+					for (int moveIndex = 0; moveIndex < captureCount; moveIndex++)
+					{
+						Sorter.SortTo(captures, captureCount, moveIndex);
+						const auto move = static_cast<Move>(captures[moveIndex]);
+						if (!eval::IsExchangeAtLeast(Board, move, exchangeThreshold))
+						{
+							continue;
+						}
+
+						Ply++;
+						Board.MakeMove(move);
+
+						// A quiescence search first, the reduced search only for captures that hold up
+						int score = -Quiescence(0, -probCutBeta, -probCutBeta + 1);
+						if (score >= probCutBeta)
+						{
+							score = -AlphaBeta<Node::NonPV>(probCutDepth - 1, -probCutBeta, -probCutBeta + 1);
+						}
+
+						Board.UndoMove();
+						Ply--;
+
+						if (ShouldStop())
+						{
+							return 0;
+						}
+
+						if (score >= probCutBeta)
+						{
+							Stats.ProbCuts++;
+							Table.Insert(
+									{
+											.Hash = Board.hash(),
+											.BestMove = move,
+											.Type = hash::EntryType::Beta,
+											.Depth = probCutDepth,
+											.Value = probCutBeta,
+											.StaticEval = Stack[Ply].StaticEval
+									});
+							return beta;
+						}
+					}
+				}
+			}
+
 			ScoredMove scoredMoves[MAX_MOVES];
 
 			int count;
@@ -236,20 +668,75 @@ namespace chess::ai::details
 
 				count = (int)(end - typedMoves);
 
-				Sorter.Populate(typedMoves, end, scoredMoves, Ply,
-						ttEntry.has_value() ? ttEntry->BestMove : Move::Empty());
+				Sorter.Populate(Board, typedMoves, end, scoredMoves, Ply, isIidMove ? Move::Empty() : hashMove);
+				if (isIidMove)
+				{
+					// Compare with the move the usual ordering would have tried first,
+					// then give the IID move the score of a hash move
+					const auto first = std::max_element(scoredMoves, scoredMoves + count,
+							[](const ScoredMove& a, const ScoredMove& b)
+							{ return a.Score < b.Score; });
+					if (first != scoredMoves + count && *first != hashMove)
+					{
+						Stats.IidImprovements++;
+					}
+
+					for (int i = 0; i < count; i++)
+					{
+						if (scoredMoves[i] == hashMove)
+						{
+							scoredMoves[i].Score = TT_MOVE_VALUE + (int)scoredMoves[i].type();
+							break;
+						}
+					}
+				}
+
+				// Only the root moves are searched, in the order of the last iteration once there is one
+				if (isRootNode)
+				{
+					int rootCount = 0;
+					for (int i = 0; i < count; i++)
+					{
+						const int rank = m_RootMoves.GetRank(scoredMoves[i]);
+						if (rank < 0)
+						{
+							continue;
+						}
+						if (m_RootMoves.isOrdered())
+						{
+							scoredMoves[i].Score = TT_MOVE_VALUE - rank;
+						}
+						scoredMoves[rootCount++] = scoredMoves[i];
+					}
+					count = rootCount;
+					m_RootMoves.ResetScores(m_ExcludedRootMoves);
+				}
 			}
 
-			bool doPvs = false;
 			int bestScore = std::numeric_limits<int>::min();
 			Move bestMove;
 
-			int newDepth = depth;
-
 			int legalMoves = 0;
 
-			bool doCutMoves = !startedInCheck && NodeType != Node::PV && Ply > 2;
-			const int cutCount = count * 2 / 3;
+			// Quiet moves searched so far, penalised in history when a later move causes a cutoff
+			ScoredMove quietMoves[MAX_MOVES];
+			int quietCount = 0;
+
+			// Futility: quiet moves not giving check can not raise alpha
+			const bool doFutilityPruning = canPruneShallow
+					&& GetStaticEval() + m_Params.FutilityMargin * depth <= alpha;
+
+			// Late move pruning: with good ordering, late quiet moves not giving check hardly ever matter
+			// at shallow depth
+			const bool doLateMovePruning = NodeType == Node::NonPV && !startedInCheck && depth <= LMP_MAX_DEPTH;
+			const int lateMoveCount = LMP_BASE_MOVES + depth * depth;
+
+			// A deep enough lower bound for the hash move, close enough to be reached again.
+			// Extensions stop at twice the iteration depth
+			const bool isSingularCandidate = !isRootNode && !isExclusionSearch && depth >= SINGULAR_MIN_DEPTH
+					&& Ply < 2 * Depth && ttEntry.has_value() && !ttEntry->FromQuiescence
+					&& (ttEntry->Type == hash::EntryType::Beta || ttEntry->Type == hash::EntryType::Exact)
+					&& ttEntry->Depth >= depth - SINGULAR_TT_DEPTH_MARGIN && std::abs(ttEntry->Value) < CHECKMATE_THRESHOLD;
 
 			// AlphaBeta move loop
 			for (int moveIndex = 0; moveIndex < count; moveIndex++)
@@ -257,65 +744,107 @@ namespace chess::ai::details
 				Sorter.SortTo(scoredMoves, count, moveIndex);
 				const auto scoredMove = scoredMoves[moveIndex];
 				const auto move = static_cast<Move>(scoredMove);
+				const bool isQuiet = scoredMove.IsQuiet();
 
-				if (doCutMoves
-						&& moveIndex >= cutCount
-						&& !scoredMove.IsCapture()
-						&& scoredMove.movedPiece().type() != core::pieces::Type::Pawn)
+				if (move == excludedMove || (hasExcludedRootMoves && std::find(m_ExcludedRootMoves.begin(),
+						m_ExcludedRootMoves.end(), move) != m_ExcludedRootMoves.end()))
 				{
-					break;
+					continue;
+				}
+
+				int extension = 0;
+				if (isSingularCandidate && move == ttEntry->BestMove)
+				{
+					const int singularBeta = ttEntry->Value - SINGULAR_MARGIN * depth;
+
+					Stack[Ply].ExcludedMove = move;
+					const int score = AlphaBeta<Node::NonPV>((depth - 1) / 2, singularBeta - 1, singularBeta);
+					Stack[Ply].ExcludedMove = Move::Empty();
+					PVLength[Ply] = Ply;
+
+					if (ShouldStop())
+					{
+						return 0;
+					}
+
+					if (score < singularBeta)
+					{
+						Stats.SingularExtensions++;
+						extension = 1;
+					}
+					else if (singularBeta >= beta)
+					{
+						// Multi-cut: the hash move and at least one other move beat beta
+						Stats.MultiCuts++;
+						return singularBeta;
+					}
 				}
 
 				legalMoves++;
+				const size_t nodesBefore = Stats.Nodes;
 				Ply++;
 				Board.MakeMove(move);
 
 				const bool isInCheck = (bool)Board.checkers();
-				int lmr = 0;
 
-				if (!doPvs && legalMoves > 1 && depth >= 3 &&
-						!startedInCheck && !isInCheck &&
-						scoredMove.type() != core::moves::Type::Quiet &&
-						scoredMove.movedPiece().type() != core::pieces::Type::Pawn &&
-						!Sorter.IsKillerMove(scoredMove, Ply - 1))
+				if (isQuiet && !isInCheck && ((doFutilityPruning && legalMoves > 1)
+						|| (doLateMovePruning && legalMoves > lateMoveCount && bestScore > -CHECKMATE_THRESHOLD)))
+				{
+					Board.UndoMove();
+					Ply--;
+					continue;
+				}
+
+				// Late quiet moves are searched shallower, less so at PV nodes, for killers and moves
+				// with good history. Not at the root, which is ordered by subtree size instead
+				int reduction = 0;
+				if (depth >= LMR_MIN_DEPTH && legalMoves > 1 && !isRootNode && isQuiet && !startedInCheck && !isInCheck)
 				{
-					lmr = 1 + (legalMoves > 6 ? Ply / 3 : 0);
+					reduction = s_Reductions[std::min(depth, LMR_TABLE_SIZE - 1)][std::min(legalMoves,
+							LMR_TABLE_SIZE - 1)];
 					if constexpr (NodeType == Node::PV)
 					{
-						lmr = lmr * 2 / 3;
+						reduction--;
 					}
-
-					if (ttEntry.has_value() && ttEntry->BestMove.IsCapture())
+					if (Sorter.IsKillerMove(scoredMove, Ply - 1))
 					{
-						lmr++;
+						reduction--;
 					}
+					reduction -= Sorter.GetHistory(scoredMove) / LMR_HISTORY_DIVISOR;
+					reduction = std::clamp(reduction, 0, depth - 2);
 				}
 
-				newDepth -= lmr;
-
+				const int newDepth = depth - 1 + extension;
 				int score;
-
-				if (doPvs)
+				if (legalMoves == 1)
 				{
-					score = -AlphaBeta<Node::PV>(newDepth - 1, -alpha - 1, -alpha);
-					if (score > alpha && score < beta)
-					{
-						score = -AlphaBeta<Node::PV>(newDepth - 1, -beta, -alpha);
-					}
+					score = -AlphaBeta<NodeType>(newDepth, -beta, -alpha);
 				}
 				else
 				{
-					score = -AlphaBeta<Node::NonPV>(newDepth - 1, -beta, -alpha);
-					if (score > alpha && lmr > 0)
+					// Null window first, reduced moves failing high are searched again at full depth
+					score = -AlphaBeta<Node::NonPV>(newDepth - reduction, -alpha - 1, -alpha);
+					if (score > alpha && reduction > 0)
 					{
-						score = -AlphaBeta<Node::NonPV>(depth - 1, -beta, -alpha);
-						newDepth = depth;
+						score = -AlphaBeta<Node::NonPV>(newDepth, -alpha - 1, -alpha);
+					}
+					if (NodeType == Node::PV && score > alpha && score < beta)
+					{
+						score = -AlphaBeta<Node::PV>(newDepth, -beta, -alpha);
 					}
 				}
 
 				Board.UndoMove();
 				Ply--;
 
+				// Moves failing low only get the alpha bound, they are ordered by subtree size.
+				// Nodes only count in the first MultiPV line, later ones search every move but the best again
+				if (isRootNode)
+				{
+					m_RootMoves.Update(move, score > alpha ? score : std::numeric_limits<int>::min(),
+							hasExcludedRootMoves ? 0 : Stats.Nodes - nodesBefore);
+				}
+
 				if (score > bestScore)
 				{
 					bestScore = score;
@@ -324,29 +853,43 @@ namespace chess::ai::details
 
 				if (score >= beta)
 				{
-					Table.Insert(
-							{
-									.Hash = Board.hash(),
-									.BestMove = bestMove,
-									.Type = hash::EntryType::Beta,
-									.Depth = newDepth,
-									.Value = beta,
-							});
+					Stack[Ply].BestMove = bestMove;
+					if (!isExclusionSearch && !hasExcludedRootMoves)
+					{
+						Table.Insert(
+								{
+										.Hash = Board.hash(),
+										.BestMove = bestMove,
+										.Type = hash::EntryType::Beta,
+										.Depth = depth,
+										.Value = beta,
+										.StaticEval = Stack[Ply].StaticEval
+								});
+					}
 
 					// Quiet promotions are not really quiet
-					if (scoredMove.type() == core::moves::Type::Quiet)
+					if (isQuiet)
 					{
 						Sorter.StoreKillerMove(scoredMove, Ply);
+
+						const int bonus = std::min(depth * depth, MAX_HISTORY_BONUS);
+						Sorter.UpdateHistory(scoredMove, bonus);
+						for (int i = 0; i < quietCount; i++)
+						{
+							Sorter.UpdateHistory(quietMoves[i], -bonus);
+						}
 					}
 
 					return beta;
 				}
 
-				if (score > alpha)
+				if (isQuiet)
 				{
-					doCutMoves = false;
+					quietMoves[quietCount++] = scoredMove;
+				}
 
-					doPvs = true;
+				if (score > alpha)
+				{
 					PV[Ply][Ply] = move;
 					for (int i = Ply + 1; i < PVLength[Ply + 1]; i++)
 					{
@@ -361,18 +904,28 @@ namespace chess::ai::details
 
 			if (legalMoves == 0)
 			{
+				// The excluded move may have been the only one
+				if (isExclusionSearch)
+				{
+					return alpha;
+				}
 				return startedInCheck ? CHECKMATE_SCORE + Ply : STALEMATE_SCORE;
 			}
 
-			Table.Insert(
-					{
-							.Hash = Board.hash(),
-							.BestMove = bestMove,
-							.Type = entryType,
-							.Depth = newDepth,
-							.Value = alpha,
-							.FromQuiescence = false
-					});
+			Stack[Ply].BestMove = bestMove;
+			if (!isExclusionSearch && !hasExcludedRootMoves)
+			{
+				Table.Insert(
+						{
+								.Hash = Board.hash(),
+								.BestMove = bestMove,
+								.Type = entryType,
+								.Depth = depth,
+								.Value = alpha,
+								.FromQuiescence = false,
+								.StaticEval = Stack[Ply].StaticEval
+						});
+			}
 
 			return alpha;
 		}
@@ -400,17 +953,19 @@ namespace chess::ai::details
 			const bool startedInCheck = (bool)Board.checkers();
 
 			Move ttMove;
+			Stack[Ply].StaticEval = hash::NO_STATIC_EVAL;
 
 			if (!startedInCheck)
 			{
 				auto ttEntry = Table.Probe(Board.hash());
-				if (ttEntry.has_value() && !Board.IsLegal(ttEntry->BestMove))
+				if (ttEntry.has_value() && ttEntry->BestMove.IsValid() && !Board.IsLegal(ttEntry->BestMove))
 				{
-					ttEntry.reset();
+					ttEntry->BestMove = Move::Empty();
 				}
 				if (ttEntry.has_value())
 				{
 					ttMove = ttEntry->BestMove;
+					Stack[Ply].StaticEval = ttEntry->StaticEval;
 					const auto hitType = ttEntry->Apply(depth, alpha, beta);
 					if (hitType != hash::EntryType::None)
 					{
@@ -426,12 +981,27 @@ namespace chess::ai::details
 					}
 				}
 
-				standPat = eval::EvaluateBoard(Board);
+				standPat = GetStandPat(alpha, beta);
 				alpha = std::max(alpha, standPat);
 				if (alpha >= beta)
 				{
 					return standPat;
 				}
+
+				// Not even taking a queen gets close to alpha, unless a pawn is about to promote
+				const auto us = Board.colorToPlay();
+				const auto promotionRank = core::lookups::GetRank(us == core::pieces::Color::White ? 1 : 6);
+				int maxGain = eval::PIECE_SCORES[(int)core::pieces::Type::Queen];
+				if (Board.GetPieces(us) & Board.GetPieces(core::pieces::Type::Pawn) & promotionRank)
+				{
+					maxGain += eval::PIECE_SCORES[(int)core::pieces::Type::Queen]
+							- eval::PIECE_SCORES[(int)core::pieces::Type::Pawn];
+				}
+				if (standPat + maxGain + DELTA_MARGIN < alpha)
+				{
+					Stats.DeltaPrunes++;
+					return alpha;
+				}
 			}
 
 			if (Ply >= MAX_PLY)
@@ -457,10 +1027,16 @@ namespace chess::ai::details
 
 				if (count == 0)
 				{
-					return startedInCheck ? CHECKMATE_SCORE + Ply : STALEMATE_SCORE;
+					if (startedInCheck)
+					{
+						return CHECKMATE_SCORE + Ply;
+					}
+
+					// No captures does not mean no moves
+					return HasLegalMove(Board) ? alpha : STALEMATE_SCORE;
 				}
 
-				Sorter.Populate(typedMoves, end, scoredMoves, Ply, ttMove);
+				Sorter.Populate(Board, typedMoves, end, scoredMoves, Ply, ttMove);
 			}
 
 			Move bestMove;
@@ -471,7 +1047,20 @@ namespace chess::ai::details
 				const auto scoredMove = scoredMoves[moveIndex];
 				const auto move = static_cast<Move>(scoredMove);
 
-				std::vector<Move> newPv;
+				// Captures losing material can not raise the stand pat
+				if (!startedInCheck && scoredMove.IsBadCapture())
+				{
+					continue;
+				}
+
+				// Neither can captures of too little, promotions aside
+				const bool isPlainCapture = move.type() == Type::Capture || move.type() == Type::EnPassant;
+				if (!startedInCheck && isPlainCapture
+						&& standPat + eval::PIECE_SCORES[(int)scoredMove.capturedPiece().type()] + DELTA_MARGIN <= alpha)
+				{
+					Stats.DeltaPrunes++;
+					continue;
+				}
 
 				Ply++;
 				Board.MakeMove(move);
@@ -481,8 +1070,11 @@ namespace chess::ai::details
 				Board.UndoMove();
 				Ply--;
 
+				// Fail hard like AlphaBeta, the entry below becomes a lower bound
 				if (score >= beta)
 				{
+					bestMove = move;
+					alpha = beta;
 					break;
 				}
 
@@ -500,6 +1092,7 @@ namespace chess::ai::details
 				}
 			}
 
+			// Stored at depth 0: the result does not depend on how deep into quiescence the node is
 			if (!startedInCheck)
 			{
 				auto entryType = hash::EntryType::Exact;
@@ -517,21 +1110,97 @@ namespace chess::ai::details
 								.Hash = Board.hash(),
 								.BestMove = bestMove,
 								.Type = entryType,
-								.Depth = depth,
+								.Depth = 0,
 								.Value = alpha,
-								.FromQuiescence = true
+								.FromQuiescence = true,
+								.StaticEval = Stack[Ply].StaticEval
 						});
 			}
 
 			return alpha;
 		}
 
+		// Static evaluation of the current node, computed at most once and shared through the TT
+		int GetStaticEval()
+		{
+			if (ProbeStaticEval())
+			{
+				return Stack[Ply].StaticEval;
+			}
+
+			const auto staticEval = eval::EvaluateBoard(Board, { &PawnTable, &MaterialTable });
+			StoreStaticEval(staticEval);
+			return staticEval;
+		}
+
+		// Stand pat only has to be compared with the window, so expensive terms may be skipped far outside it.
+		// Lazy scores are not exact and are never cached
+		int GetStandPat(const int alpha, const int beta)
+		{
+			if (ProbeStaticEval())
+			{
+				return Stack[Ply].StaticEval;
+			}
+
+			bool isLazy;
+			const auto staticEval = eval::EvaluateBoard(Board, { &PawnTable, &MaterialTable }, alpha, beta, isLazy);
+			Stats.LazyEvals++;
+			if (isLazy)
+			{
+				Stats.LazySkips++;
+				return staticEval;
+			}
+
+			StoreStaticEval(staticEval);
+			return staticEval;
+		}
+
+		bool ProbeStaticEval()
+		{
+			auto& staticEval = Stack[Ply].StaticEval;
+			if (staticEval != hash::NO_STATIC_EVAL)
+			{
+				return true;
+			}
+
+			const auto cached = EvalTable.Probe(Board.hash());
+			if (cached.has_value())
+			{
+				staticEval = cached->Value;
+				return true;
+			}
+
+			return false;
+		}
+
+		void StoreStaticEval(const int staticEval)
+		{
+			Stack[Ply].StaticEval = staticEval;
+			EvalTable.Insert({ .Hash = Board.hash(), .Value = staticEval });
+		}
+
 	public:
 		hash::TranspositionTable& Table;
+		hash::PawnTable PawnTable;
+		hash::MaterialTable MaterialTable;
+		hash::EvalTable EvalTable;
 		MoveSorter<MAX_PLY>& Sorter;
 
 		core::Board Board;
 
+		struct StackEntry
+		{
+			int StaticEval = hash::NO_STATIC_EVAL;
+			// The move made from this ply passed the turn
+			bool IsNullMove = false;
+			// Best move of the last completed search at this ply, read back by internal iterative deepening
+			Move BestMove;
+			// Skipped by the singular extension search of this ply
+			Move ExcludedMove;
+		};
+
+		std::array<StackEntry, MAX_PLY + 1> Stack;
+
 		std::array<std::array<Move, MAX_PLY + 1>, MAX_PLY + 1> PV;
 		std::array<int, MAX_PLY + 1> PVLength;
 		int Ply = 0;
@@ -541,6 +1210,19 @@ namespace chess::ai::details
 		{
 			size_t Nodes = 0;
 			size_t TTHits = 0;
+			size_t LazyEvals = 0;
+			size_t LazySkips = 0;
+			size_t BitbaseHits = 0;
+			size_t TablebaseHits = 0;
+			size_t NullMoveCuts = 0;
+			size_t IidSearches = 0;
+			// IID best move differs from the first move of the usual ordering
+			size_t IidImprovements = 0;
+			size_t SingularExtensions = 0;
+			size_t MultiCuts = 0;
+			size_t ProbCuts = 0;
+			size_t DeltaPrunes = 0;
+			size_t UpcomingRepetitions = 0;
 			int SelDepth = 0;
 		} Stats;
 
@@ -549,6 +1231,27 @@ namespace chess::ai::details
 			m_StopFlag = true;
 		}
 
+		NODISCARD int lastBestScore() const
+		{
+			return m_LastBestScore;
+		}
+
+		// Of the last completed iteration
+		NODISCARD double bestMoveNodeFraction() const
+		{
+			return m_BestMoveNodeFraction;
+		}
+
+		NODISCARD Move lastBestMove() const
+		{
+			return m_LastLines.empty() || m_LastLines[0].PV.empty() ? Move::Empty() : m_LastLines[0].PV[0];
+		}
+
+		NODISCARD int completedDepth() const
+		{
+			return m_CompletedDepth;
+		}
+
 		NODISCARD bool IsReady()
 		{
 			std::scoped_lock lock(m_Mutex);
@@ -557,6 +1260,7 @@ namespace chess::ai::details
 
 	protected:
 		SharedData& m_SharedData;
+		SearchParams m_Params;
 		std::mutex m_Mutex;
 
 		void Reset()
@@ -565,8 +1269,12 @@ namespace chess::ai::details
 
 			PVLength.fill(0);
 			Stats = {};
+			PawnTable.ResetStats();
+			MaterialTable.ResetStats();
+			EvalTable.ResetStats();
 			m_StopFlag = false;
 			m_StopCheckCounter = 0;
+			m_NullMoveMinPly = 0;
 			Ply = 0;
 		}
 
@@ -593,6 +1301,15 @@ namespace chess::ai::details
 
 		bool m_FirstSearch = true;
 		int m_LastBestScore = 0;
+		// Lines of the last completed iteration, best first
+		std::vector<SearchResult> m_LastLines;
+		std::vector<Move> m_ExcludedRootMoves;
+		RootMoves m_RootMoves;
+		double m_BestMoveNodeFraction = 0;
+		int m_CompletedDepth = 0;
+		int m_RootPieces = 0;
+		// Null moves are not tried before this ply while verifying a null move cutoff
+		int m_NullMoveMinPly = 0;
 		bool m_Ready = true;
 	};
 
@@ -602,15 +1319,20 @@ namespace chess::ai::details
 	{
 	public:
 		MainThread(const core::Board& board, hash::TranspositionTable& table, details::MoveSorter<MAX_PLY>& sorter,
-				SharedData& data, const std::atomic_bool& stopFlag)
-				:Thread(board, table, sorter, data), m_StopFlag(stopFlag), m_MaxTime{ 0 }
+				SharedData& data, const SearchParams& searchParams, const std::atomic_bool& stopFlag)
+				:Thread(board, table, sorter, data, searchParams), m_StopFlag(stopFlag)
 		{
 		}
 
 		void InitSearch(const Clock::time_point startTime, const SearchParams& searchParams, const bool verbose)
 		{
 			m_StartTime = startTime;
-			m_MaxTime = searchParams.MaxTime;
+			m_TimeManager = TimeManager(searchParams);
+			if (verbose)
+			{
+				std::cout << "Info: time optimum " << m_TimeManager.optimumTime()
+						  << " maximum " << m_TimeManager.maximumTime() << std::endl;
+			}
 
 			int threadCount = std::max(0, searchParams.MaxWorkers - 1);
 			threadCount = std::min(threadCount, (int)std::thread::hardware_concurrency());
@@ -618,7 +1340,7 @@ namespace chess::ai::details
 
 			for (int tid = 0; tid < threadCount; tid++)
 			{
-				threads.emplace_back(Board, Table, Sorter, m_SharedData);
+				threads.emplace_back(Board, Table, Sorter, m_SharedData, m_Params);
 			}
 
 			const int maxDepth = searchParams.MaxDepth > 0 ? std::min(searchParams.MaxDepth, MAX_PLY + 1) : MAX_PLY + 1;
@@ -630,6 +1352,7 @@ namespace chess::ai::details
 
 			int counter = 0;
 			int rootDepth = 1;
+			int updatedDepth = 0;
 			while (rootDepth < maxDepth)
 			{
 				const bool shouldStop = ShouldStop();
@@ -664,6 +1387,24 @@ namespace chess::ai::details
 				}
 
 				rootDepth = m_SharedData.GetHighestDepth() + 1;
+
+				if (completedDepth() > updatedDepth)
+				{
+					updatedDepth = completedDepth();
+					m_TimeManager.Update(lastBestMove(), lastBestScore(), bestMoveNodeFraction());
+				}
+
+				// Shallow iterations are too quick to tell anything about stability
+				const auto passedTime = std::chrono::duration<double>(Clock::now() - m_StartTime);
+				if (m_SharedData.GetHighestDepth() >= TIME_MANAGEMENT_MIN_DEPTH
+						&& !m_TimeManager.ShouldStartIteration(passedTime.count()))
+				{
+					for (auto& thread : threads)
+					{
+						thread.Stop();
+					}
+					break;
+				}
 			}
 
 			// Wait for all threads to finish
@@ -689,18 +1430,51 @@ namespace chess::ai::details
 				return true;
 			}
 			const auto passedTime = std::chrono::duration<double>(Clock::now() - m_StartTime);
-			return passedTime.count() > m_MaxTime;
+			return m_TimeManager.IsOutOfTime(passedTime.count());
 		}
 
 	private:
+		static constexpr int TIME_MANAGEMENT_MIN_DEPTH = 4;
+
 		const std::atomic_bool& m_StopFlag;
-		double m_MaxTime;
+		TimeManager m_TimeManager;
 		Clock::time_point m_StartTime;
 	};
 
 	void Search::StartSearch(const core::Board& board, const SearchParams searchParams, const bool verbose,
-			const SearchHook* depthSearchedHook)
+			const SearchHook* depthSearchedHook, const SearchResultHook* resultHook)
 	{
+		if (searchParams.MateMoves > 0)
+		{
+			MateSolver solver(searchParams.TableSize > 0 ? searchParams.TableSize : MateSolver::DEFAULT_TABLE_SIZE);
+			const auto result = solver.Solve(board, searchParams.MateMoves, searchParams.MaxTime,
+					(size_t)std::max(0, searchParams.MaxNodes));
+
+			if (verbose)
+			{
+				if (result.Outcome == MateSolver::Status::Mate)
+				{
+					std::cout << "Info: mate in " << result.MateIn << " nodes " << result.Nodes << " pv ";
+					for (const auto move: result.Line)
+					{
+						std::cout << core::misc::MoveToString(move) << ' ';
+					}
+					std::cout << std::endl;
+				}
+				else
+				{
+					std::cout << "Info: " << (result.Outcome == MateSolver::Status::NoMate ? "no mate" : "unknown")
+							  << " within " << searchParams.MateMoves << " nodes " << result.Nodes << std::endl;
+				}
+			}
+
+			if (depthSearchedHook && !result.Line.empty())
+			{
+				depthSearchedHook->operator()(result.MateIn, result.Line.data(), (int)result.Line.size());
+			}
+			return;
+		}
+
 		// Preparations count towards search time
 		const auto startTime = Clock::now();
 
@@ -727,14 +1501,67 @@ namespace chess::ai::details
 			}
 		}
 
+		// Tablebase positions are not searched, the move that keeps the result and makes progress is played
+		if (board.occupancy().PopCount() <= database::syzygy::GetMaxPieces())
+		{
+			const auto rootResult = database::syzygy::ProbeRoot(board);
+			if (rootResult.has_value())
+			{
+				if (verbose)
+				{
+					std::cout << "Info: tablebase wdl " << (int)rootResult->Result << " dtz " << rootResult->Dtz
+							  << " move " << core::misc::MoveToString(rootResult->BestMove) << std::endl;
+				}
+
+				if (depthSearchedHook)
+				{
+					depthSearchedHook->operator()(0, &rootResult->BestMove, 1);
+				}
+				return;
+			}
+		}
+
+		// Generated on first use, once the game gets close to positions they cover
+		static constexpr int BITBASE_INIT_PIECES = 8;
+		if (!database::bitbase::IsReady() && board.occupancy().PopCount() <= BITBASE_INIT_PIECES)
+		{
+			database::bitbase::Init();
+		}
+
 		hash::TranspositionTable transpositionTable;
 		transpositionTable.Reset(searchParams.TableSize, searchParams.TableBucketSize);
 		MoveSorter<MAX_PLY> moveSorter;
 
 		m_StopFlag = false;
 
-		SharedData sharedData(depthSearchedHook);
-		MainThread mainThread(board, transpositionTable, moveSorter, sharedData, m_StopFlag);
+		SharedData sharedData(depthSearchedHook, resultHook);
+		MainThread mainThread(board, transpositionTable, moveSorter, sharedData, searchParams, m_StopFlag);
 		mainThread.InitSearch(startTime, searchParams, verbose);
 	}
-}
\ No newline at end of file
+
+	FixedDepthSearch::FixedDepthSearch(const int tableSize, const int tableBucketSize)
+			:m_SharedData(std::make_unique<SharedData>(nullptr))
+	{
+		m_Table.Reset(tableSize, tableBucketSize);
+		m_Thread = std::make_unique<Thread>(core::Board(), m_Table, m_Sorter, *m_SharedData);
+	}
+
+	FixedDepthSearch::~FixedDepthSearch() = default;
+
+	int FixedDepthSearch::Run(const core::Board& board, const int depth)
+	{
+		m_Table.NextGeneration();
+		m_Sorter.Reset();
+		m_Thread->SetRoot(board);
+
+		m_Nodes = 0;
+		const int maxDepth = std::clamp(depth, 1, MAX_PLY);
+		for (int rootDepth = 1; rootDepth <= maxDepth; rootDepth++)
+		{
+			m_Thread->Search(false, rootDepth, false);
+			m_Nodes += m_Thread->Stats.Nodes;
+		}
+
+		return m_Thread->lastBestScore();
+	}
+}
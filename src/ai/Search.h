@@ -6,9 +6,11 @@
 
 #include <vector>
 #include <atomic>
+#include <memory>
 
 #include "../core/Board.h"
 #include "hash/TranspositionTable.h"
+#include "hash/EvalTable.h"
 #include "MoveSorter.h"
 #include "Defs.h"
 #include "../database/BookMoveSelector.h"
@@ -25,6 +27,7 @@ namespace chess::ai::details
 	};
 
 	using SearchHook = std::function<void(int, const core::moves::Move*, int)>;
+	using SearchResultHook = std::function<void(const SearchResult&)>;
 
 	class Search
 	{
@@ -34,8 +37,9 @@ namespace chess::ai::details
 			m_BookMoveSelectorPtr = bookMoveSelector;
 		}
 
+		// The depth hook gets the best line of every completed iteration, the result hook all of its lines
 		void StartSearch(const core::Board& board, SearchParams searchParams, bool verbose = false,
-				const SearchHook* depthSearchedHook = nullptr);
+				const SearchHook* depthSearchedHook = nullptr, const SearchResultHook* resultHook = nullptr);
 
 		void StopGrace()
 		{
@@ -47,4 +51,36 @@ namespace chess::ai::details
 		database::BookMoveSelector* m_BookMoveSelectorPtr;
 		std::atomic_bool m_StopFlag = false;
 	};
-}
\ No newline at end of file
+
+	struct SharedData;
+	struct Thread;
+
+	// Single threaded iterative deepening to a fixed depth, without book or time limit.
+	// Tables are kept between runs, so repeated searches do not allocate
+	class FixedDepthSearch
+	{
+	public:
+		static constexpr int DEFAULT_TABLE_SIZE = 1 << 16;
+		static constexpr int DEFAULT_TABLE_BUCKET_SIZE = 4;
+
+		explicit FixedDepthSearch(int tableSize = DEFAULT_TABLE_SIZE, int tableBucketSize = DEFAULT_TABLE_BUCKET_SIZE);
+		~FixedDepthSearch();
+
+		// Side to move relative score. Every run starts with a new table generation, so earlier runs do not
+		// change the result and the table is not cleared per position
+		NODISCARD int Run(const core::Board& board, int depth);
+
+		// Nodes searched by the last run, over all iterations
+		NODISCARD size_t nodes() const
+		{
+			return m_Nodes;
+		}
+
+	private:
+		hash::TranspositionTable m_Table;
+		MoveSorter<MAX_PLY> m_Sorter;
+		std::unique_ptr<SharedData> m_SharedData;
+		std::unique_ptr<Thread> m_Thread;
+		size_t m_Nodes = 0;
+	};
+}
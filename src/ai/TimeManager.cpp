@@ -0,0 +1,72 @@
+//
+// Created by matvey on 18.10.26.
+//
+
+#include "TimeManager.h"
+
+#include <algorithm>
+
+namespace chess::ai::details
+{
+	// The clock is spread over this many moves when the moves to go are unknown
+	static constexpr int DEFAULT_MOVES_TO_GO = 40;
+	static constexpr int MAX_MOVES_TO_GO = 50;
+	// Part of the increment spent right away, the rest is kept as a reserve
+	static constexpr double INCREMENT_SHARE = 0.8;
+	static constexpr double MAXIMUM_OPTIMUM_RATIO = 5;
+	static constexpr double MAXIMUM_CLOCK_SHARE = 0.8;
+	static constexpr double MIN_TIME = 0.01;
+
+	static constexpr double ITERATION_START_SHARE = 0.6;
+	static constexpr double BEST_MOVE_CHANGE_SCALE = 0.5;
+	// Score drops up to this many centipawns scale the optimum up to 1 + SCORE_DROP_SCALE
+	static constexpr int SCORE_DROP_LIMIT = 100;
+	static constexpr double SCORE_DROP_SCALE = 0.5;
+	static constexpr double NODE_FRACTION_SCALE = 0.5;
+	static constexpr double MIN_SCALE = 0.3;
+	static constexpr double MAX_SCALE = 2.5;
+
+	TimeManager::TimeManager(const SearchParams& params)
+	{
+		if (params.RemainingTime <= 0)
+		{
+			m_MaximumTime = std::max(params.MaxTime - params.MoveOverhead, MIN_TIME);
+			m_OptimumTime = m_MaximumTime;
+			return;
+		}
+
+		const double clock = std::max(params.RemainingTime - params.MoveOverhead, 0.0);
+		const int movesToGo = params.MovesToGo > 0 ? std::min(params.MovesToGo, MAX_MOVES_TO_GO) : DEFAULT_MOVES_TO_GO;
+
+		m_OptimumTime = clock / movesToGo + params.Increment * INCREMENT_SHARE;
+		m_MaximumTime = std::min(m_OptimumTime * MAXIMUM_OPTIMUM_RATIO, clock * MAXIMUM_CLOCK_SHARE);
+		if (params.MaxTime > 0)
+		{
+			m_MaximumTime = std::min(m_MaximumTime, params.MaxTime);
+		}
+
+		m_MaximumTime = std::max(m_MaximumTime, MIN_TIME);
+		m_OptimumTime = std::clamp(m_OptimumTime, MIN_TIME, m_MaximumTime);
+	}
+
+	void TimeManager::Update(const core::moves::Move bestMove, const int score, const double bestMoveNodeFraction)
+	{
+		const bool isFirstIteration = m_Iterations++ == 0;
+
+		m_BestMoveChanges = m_BestMoveChanges / 2 + (!isFirstIteration && bestMove != m_LastBestMove ? 1 : 0);
+		const int scoreDrop = isFirstIteration ? 0 : std::clamp(m_LastScore - score, 0, SCORE_DROP_LIMIT);
+
+		const double instability = 1 + BEST_MOVE_CHANGE_SCALE * m_BestMoveChanges;
+		const double fall = 1 + SCORE_DROP_SCALE * scoreDrop / SCORE_DROP_LIMIT;
+		const double effort = 1 - NODE_FRACTION_SCALE * bestMoveNodeFraction;
+		m_Scale = std::clamp(instability * fall * effort, MIN_SCALE, MAX_SCALE);
+
+		m_LastBestMove = bestMove;
+		m_LastScore = score;
+	}
+
+	bool TimeManager::ShouldStartIteration(const double elapsed) const
+	{
+		return elapsed <= std::min(m_OptimumTime * m_Scale, m_MaximumTime) * ITERATION_START_SHARE;
+	}
+}
@@ -0,0 +1,56 @@
+//
+// Created by matvey on 18.10.26.
+//
+
+#pragma once
+
+#include "Facade.h"
+#include "../core/Common.h"
+#include "../core/moves/Move.h"
+
+namespace chess::ai::details
+{
+	// Time budget of one search, in seconds. With a clock the optimum is the share of the remaining time
+	// for this move and the maximum a hard cap well inside it. Without one both are MaxTime.
+	// The optimum is scaled after every iteration: up when the best move changes or the score drops,
+	// down when most root nodes go to the best move
+	class TimeManager
+	{
+	public:
+		TimeManager() = default;
+		explicit TimeManager(const SearchParams& params);
+
+		// After every completed iteration
+		void Update(core::moves::Move bestMove, int score, double bestMoveNodeFraction);
+
+		// An iteration takes longer than all the ones before it, so the next is not started when it
+		// could hardly finish in the scaled optimum
+		NODISCARD bool ShouldStartIteration(double elapsed) const;
+
+		NODISCARD bool IsOutOfTime(const double elapsed) const
+		{
+			return elapsed > m_MaximumTime;
+		}
+
+		NODISCARD double optimumTime() const
+		{
+			return m_OptimumTime;
+		}
+
+		NODISCARD double maximumTime() const
+		{
+			return m_MaximumTime;
+		}
+
+	private:
+		double m_OptimumTime = 0;
+		double m_MaximumTime = 0;
+		double m_Scale = 1;
+
+		core::moves::Move m_LastBestMove;
+		int m_LastScore = 0;
+		int m_Iterations = 0;
+		// Decays by half every iteration
+		double m_BestMoveChanges = 0;
+	};
+}
@@ -0,0 +1,67 @@
+//
+// Created by matvey on 18.10.26.
+//
+
+#pragma once
+
+#include <vector>
+#include <optional>
+
+#include "../../core/Common.h"
+
+namespace chess::ai::hash
+{
+	// Direct mapped, always replace cache of entries keyed by their full 64-bit Hash member.
+	// Not synchronized, every search thread owns its own tables
+	template<class Entry>
+	class DirectMappedTable
+	{
+	public:
+		explicit DirectMappedTable(const int size)
+				:m_Data(size)
+		{
+			assert(size > 0);
+		}
+
+		void Insert(const Entry& entry)
+		{
+			m_Data[entry.Hash % m_Data.size()] = entry;
+		}
+
+		NODISCARD std::optional<Entry> Probe(const uint64_t hash)
+		{
+			m_Probes++;
+
+			const auto& entry = m_Data[hash % m_Data.size()];
+			if (entry.Hash != hash)
+			{
+				return {};
+			}
+
+			m_Hits++;
+			return entry;
+		}
+
+		NODISCARD size_t hits() const
+		{
+			return m_Hits;
+		}
+
+		NODISCARD size_t probes() const
+		{
+			return m_Probes;
+		}
+
+		void ResetStats()
+		{
+			m_Hits = 0;
+			m_Probes = 0;
+		}
+
+	private:
+		std::vector<Entry> m_Data;
+
+		size_t m_Hits = 0;
+		size_t m_Probes = 0;
+	};
+}
@@ -0,0 +1,28 @@
+//
+// Created by matvey on 18.10.26.
+//
+
+#pragma once
+
+#include "DirectMappedTable.h"
+
+namespace chess::ai::hash
+{
+	struct EvalEntry
+	{
+		uint64_t Hash{};
+		int Value{};
+	};
+
+	// Static evaluations of positions that have no transposition table entry yet
+	class EvalTable : public DirectMappedTable<EvalEntry>
+	{
+	public:
+		static constexpr int DEFAULT_SIZE = 1 << 16;
+
+		explicit EvalTable(const int size = DEFAULT_SIZE)
+				:DirectMappedTable(size)
+		{
+		}
+	};
+}
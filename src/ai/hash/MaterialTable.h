@@ -0,0 +1,46 @@
+//
+// Created by matvey on 18.10.26.
+//
+
+#pragma once
+
+#include <array>
+
+#include "DirectMappedTable.h"
+
+namespace chess::ai::hash
+{
+	enum struct EndGame : uint8_t
+	{
+		None,
+		// Insufficient mating material for both sides
+		Draw,
+		// Lone king against mating material
+		KXK,
+		KBNK
+	};
+
+	struct MaterialEntry
+	{
+		static constexpr int SCALE_NORMAL = 64;
+
+		uint64_t Hash{};
+		EndGame Type = EndGame::None;
+		core::pieces::Color StrongSide{};
+		// Multiplier out of SCALE_NORMAL for the evaluation when that side is ahead
+		std::array<int, core::pieces::COLORS> ScaleFactors{ SCALE_NORMAL, SCALE_NORMAL };
+		// One bishop each and no other pieces, drawish if they are on different colors
+		bool SingleBishops = false;
+	};
+
+	class MaterialTable : public DirectMappedTable<MaterialEntry>
+	{
+	public:
+		static constexpr int DEFAULT_SIZE = 1 << 12;
+
+		explicit MaterialTable(const int size = DEFAULT_SIZE)
+				:DirectMappedTable(size)
+		{
+		}
+	};
+}
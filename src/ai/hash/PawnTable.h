@@ -0,0 +1,30 @@
+//
+// Created by matvey on 18.10.26.
+//
+
+#pragma once
+
+#include "DirectMappedTable.h"
+
+namespace chess::ai::hash
+{
+	struct PawnEntry
+	{
+		uint64_t Hash{};
+		// Isolated and doubled pawns, white minus black
+		int StructureScore{};
+		// White minus black, not yet scaled for end game
+		int PassedScore{};
+	};
+
+	class PawnTable : public DirectMappedTable<PawnEntry>
+	{
+	public:
+		static constexpr int DEFAULT_SIZE = 1 << 14;
+
+		explicit PawnTable(const int size = DEFAULT_SIZE)
+				:DirectMappedTable(size)
+		{
+		}
+	};
+}
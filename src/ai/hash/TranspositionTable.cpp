@@ -11,10 +11,23 @@ namespace chess::ai::hash
 		std::scoped_lock lock(m_Mutex);
 
 		auto* bucket = GetBucket(entry.Hash);
+		auto stampedEntry = entry;
+		stampedEntry.Generation = m_Generation;
+
+		// Stale slots are taken in order before the bucket grows, so the current entries stay in insertion
+		// order just like in a cleared table
+		for (auto& bucketEntry : *bucket)
+		{
+			if (bucketEntry.Generation != m_Generation)
+			{
+				bucketEntry = stampedEntry;
+				return;
+			}
+		}
 
 		if ((int)bucket->size() < m_BucketSize)
 		{
-			bucket->push_back(entry);
+			bucket->push_back(stampedEntry);
 			return;
 		}
 
@@ -22,7 +35,7 @@ namespace chess::ai::hash
 		{
 			if (bucketEntry.Depth < entry.Depth)
 			{
-				bucketEntry = entry;
+				bucketEntry = stampedEntry;
 				return;
 			}
 		}
@@ -37,7 +50,7 @@ namespace chess::ai::hash
 		}
 		for (const auto entry : *bucket)
 		{
-			if (entry.Hash == hash)
+			if (entry.Hash == hash && entry.Generation == m_Generation)
 			{
 				return entry;
 			}
@@ -71,5 +84,22 @@ namespace chess::ai::hash
 			m_Data.emplace_back();
 		}
 	}
-}
 
+	void TranspositionTable::Clear()
+	{
+		std::scoped_lock lock(m_Mutex);
+
+		for (auto& bucket : m_Data)
+		{
+			bucket.clear();
+		}
+	}
+
+	void TranspositionTable::NextGeneration()
+	{
+		if (++m_Generation == 0)
+		{
+			Clear();
+		}
+	}
+}
@@ -7,6 +7,7 @@
 #include <vector>
 #include <optional>
 #include <mutex>
+#include <limits>
 
 #include "../../core/Common.h"
 #include "../../core/moves/Move.h"
@@ -18,6 +19,8 @@ namespace chess::ai::hash
 		None, Exact, Alpha, Beta
 	};
 
+	static constexpr int NO_STATIC_EVAL = std::numeric_limits<int>::min();
+
 	struct TableEntry
 	{
 		uint64_t Hash{};
@@ -26,6 +29,9 @@ namespace chess::ai::hash
 		int Depth{};
 		int Value{};
 		bool FromQuiescence{};
+		// Set by the table on insertion
+		uint8_t Generation{};
+		int StaticEval = NO_STATIC_EVAL;
 
 		constexpr EntryType Apply(const int depth, int& alpha, int& beta) const
 		{
@@ -67,6 +73,11 @@ namespace chess::ai::hash
 		NODISCARD __attribute__((no_address_safety_analysis)) std::optional<TableEntry> Probe(uint64_t hash);
 
 		void Reset(int maxSize, int bucketSize);
+		// Drops all entries but keeps the allocated buckets
+		void Clear();
+		// Hides all entries without touching them: entries of older generations are not probed
+		// and are replaced first. A full Clear only happens when the counter wraps around
+		void NextGeneration();
 	private:
 		NODISCARD std::vector<TableEntry>* GetBucket(uint64_t hash);
 		NODISCARD const std::vector<TableEntry>* GetBucket(uint64_t hash) const;
@@ -77,5 +88,6 @@ namespace chess::ai::hash
 
 		int m_MaxSize;
 		int m_BucketSize;
+		uint8_t m_Generation = 0;
 	};
 }
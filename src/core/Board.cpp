@@ -5,6 +5,7 @@
 #include "Lookups.h"
 #include "Board.h"
 #include "Magic.h"
+#include "hash/Cuckoo.h"
 
 namespace chess::core
 {
@@ -171,10 +172,19 @@ namespace chess::core
 		}
 
 		m_Evaluator.FeedRemoveAt(square, removedPiece);
+		if (eval::nnue::IsLoaded())
+		{
+			m_Accumulator.FeedRemoveAt(square, removedPiece);
+		}
 		m_Zobrist.TogglePiece(square, removedPiece);
+		if (removedPiece.type() == pieces::Type::Pawn || removedPiece.type() == pieces::Type::King)
+		{
+			m_PawnZobrist.TogglePiece(square, removedPiece);
+		}
 
 		m_Pieces[square.value()] = pieces::Piece::Invalid();
-		m_PieceCounts[(int)removedPiece.color()][(int)removedPiece.type()]--;
+		const auto count = --m_PieceCounts[(int)removedPiece.color()][(int)removedPiece.type()];
+		m_MaterialZobrist.ToggleMaterial(removedPiece, count);
 
 		const auto invBB = ~Bitboard().WithSet(square);
 
@@ -218,10 +228,19 @@ namespace chess::core
 		m_OccupancyBB |= squareBB;
 
 		m_Pieces[square.value()] = piece;
-		m_PieceCounts[(int)piece.color()][(int)piece.type()]++;
+		const auto count = m_PieceCounts[(int)piece.color()][(int)piece.type()]++;
+		m_MaterialZobrist.ToggleMaterial(piece, count);
 
 		m_Evaluator.FeedSetAt(square, piece);
+		if (eval::nnue::IsLoaded())
+		{
+			m_Accumulator.FeedSetAt(square, piece);
+		}
 		m_Zobrist.TogglePiece(square, piece);
+		if (piece.type() == pieces::Type::Pawn || piece.type() == pieces::Type::King)
+		{
+			m_PawnZobrist.TogglePiece(square, piece);
+		}
 	}
 
 	void Board::Clear()
@@ -246,7 +265,10 @@ namespace chess::core
 		m_EndGameWeight = 0;
 
 		m_Evaluator = {};
+		m_Accumulator.Reset();
 		m_Zobrist = {};
+		m_PawnZobrist = {};
+		m_MaterialZobrist = {};
 	}
 
 	void Board::MakeMove(const moves::Move move)
@@ -479,6 +501,54 @@ namespace chess::core
 		assert(hash() == undoInfo.ValidHash);
 	}
 
+	void Board::MakeNullMove()
+	{
+		assert(!checkers());
+
+		// Positions after a null move can not repeat the ones before it
+		m_MoveHistory.push_back(MoveUndoInfo
+				{
+						.Move = moves::Move::Empty(),
+						.CapturedPiece = {},
+						.EpFile = m_EpFile,
+						.HalfMoves = m_HalfMoves,
+						.CastlingRights = m_CastlingRights,
+						.CheckersBB = m_CheckersBB,
+						.Pins = m_PinsInfos,
+						.AttackedBBs = m_AttackedBBs,
+						.MaxRepetitions = m_MaxRepetitions,
+						.Repetitions = std::move(m_Repetitions),
+						.ValidHash = hash()
+				});
+		m_Repetitions.clear();
+		m_MaxRepetitions = 0;
+
+		ChangeSidesInternal();
+		SetEpFileInternal(INVALID_FILE);
+		m_HalfMoves++;
+
+		// The side that passed can not have given check
+		m_CheckersBB = Bitboard();
+	}
+
+	void Board::UndoNullMove()
+	{
+		assert(!m_MoveHistory.empty());
+		assert(!m_MoveHistory.back().Move.IsValid());
+
+		auto& undoInfo = m_MoveHistory.back();
+		m_Repetitions = std::move(undoInfo.Repetitions);
+		m_MaxRepetitions = undoInfo.MaxRepetitions;
+
+		ChangeSidesInternal();
+		SetEpFileInternal(undoInfo.EpFile);
+		m_HalfMoves = undoInfo.HalfMoves;
+		m_CheckersBB = undoInfo.CheckersBB;
+
+		assert(hash() == undoInfo.ValidHash);
+		m_MoveHistory.pop_back();
+	}
+
 	void Board::ChangeSidesInternal()
 	{
 		m_Zobrist.ToggleColorToPlay();
@@ -550,6 +620,11 @@ namespace chess::core
 		m_CheckersBB = GetAttackedBy(GetKingSquare(colorToPlay()));
 	}
 
+	void Board::RefreshAccumulator()
+	{
+		m_Accumulator.Refresh(m_Pieces);
+	}
+
 	Board Board::CloneWithoutHistory() const
 	{
 		Board board{ *this };
@@ -670,6 +745,56 @@ namespace chess::core
 		return m_MaxRepetitions;
 	}
 
+	bool Board::HasUpcomingRepetition() const
+	{
+		const int historySize = (int)m_MoveHistory.size();
+		const int maxDistance = std::min(m_HalfMoves, historySize);
+		if (maxDistance < 3)
+		{
+			return false;
+		}
+
+		const auto isNullMove = [this, historySize](const int distance)
+		{
+			return !m_MoveHistory[historySize - distance].Move.IsValid();
+		};
+		if (isNullMove(1))
+		{
+			return false;
+		}
+
+		// Only positions with the other side to move differ by a single move
+		for (int distance = 3; distance <= maxDistance; distance += 2)
+		{
+			if (isNullMove(distance - 1) || isNullMove(distance))
+			{
+				return false;
+			}
+
+			const auto& undoInfo = m_MoveHistory[historySize - distance];
+			const auto move = hash::cuckoo::FindMove(hash() ^ undoInfo.ValidHash);
+			if (!move.IsValid() || (lookups::GetInBetween(move.start(), move.end()) & m_OccupancyBB))
+			{
+				continue;
+			}
+
+			const auto square = GetPiece(move.start()).IsValid() ? move.start() : move.end();
+			if (GetPiece(square).color() != m_ColorToPlay)
+			{
+				continue;
+			}
+
+			// Seen twice, a third time is a draw
+			const auto repetitionIt = m_Repetitions.find(undoInfo.ValidHash);
+			if (repetitionIt != m_Repetitions.end() && repetitionIt->second >= 2)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
 	template void Board::SetPiece<false>(chess::core::Square, pieces::Piece);
 	template void Board::SetPiece<true>(chess::core::Square, pieces::Piece);
 }
\ No newline at end of file
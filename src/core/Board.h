@@ -9,6 +9,7 @@
 #include <map>
 #include "hash/Zobrist.h"
 #include "eval/IncrementalPieceSquareEvaluator.h"
+#include "eval/Nnue.h"
 #include "Lookups.h"
 #include "moves/Move.h"
 
@@ -130,6 +131,10 @@ namespace chess::core
 		void MakeMove(moves::Move move);
 		void UndoMove();
 
+		// Passes the turn without moving a piece, not allowed in check
+		void MakeNullMove();
+		void UndoNullMove();
+
 		NODISCARD constexpr pieces::Piece GetPiece(const Square square) const
 		{
 			assert(square.IsValid());
@@ -156,11 +161,32 @@ namespace chess::core
 			return m_Zobrist.value();
 		}
 
+		// Pawns and kings only
+		NODISCARD constexpr uint64_t pawnHash() const
+		{
+			return m_PawnZobrist.value();
+		}
+
+		// Piece counts only
+		NODISCARD constexpr uint64_t materialHash() const
+		{
+			return m_MaterialZobrist.value();
+		}
+
 		NODISCARD constexpr const eval::IncrementalPieceSquareEvaluator& eval() const
 		{
 			return m_Evaluator;
 		}
 
+		// Only kept up to date while a network is loaded
+		NODISCARD constexpr const eval::nnue::Accumulator& accumulator() const
+		{
+			return m_Accumulator;
+		}
+
+		// Rebuilds the accumulator from scratch, needed after a network is loaded or replaced
+		void RefreshAccumulator();
+
 		NODISCARD constexpr Square GetKingSquare(const pieces::Color color) const
 		{
 			const auto index = (GetPieces(pieces::Type::King) & GetPieces(color)).BitScanForward();
@@ -188,6 +214,9 @@ namespace chess::core
 
 		NODISCARD bool IsLegal(moves::Move move) const;
 		NODISCARD int GetMaxRepetitions() const;
+		// The side to move has a reversible move back to a position already repeated in this game,
+		// with no pawn move, capture or null move since
+		NODISCARD bool HasUpcomingRepetition() const;
 	private:
 		void ChangeSidesInternal();
 		void SetCastlingRightsInternal(pieces::CastlingRights cr);
@@ -216,7 +245,10 @@ namespace chess::core
 		int m_EndGameWeight = 0;
 
 		hash::ZobristHash m_Zobrist{};
+		hash::ZobristHash m_PawnZobrist{};
+		hash::ZobristHash m_MaterialZobrist{};
 		eval::IncrementalPieceSquareEvaluator m_Evaluator{};
+		eval::nnue::Accumulator m_Accumulator{};
 
 		std::vector<MoveUndoInfo> m_MoveHistory{};
 
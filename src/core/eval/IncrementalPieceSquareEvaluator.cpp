@@ -99,37 +99,58 @@ namespace chess::core::eval
 						s_RookValues,
 						s_QueenValues
 				};
+
+		constexpr std::array<int, pieces::PIECES> s_MaterialValues{ 100, 290, 310, 515, 900, 0 };
+		constexpr std::array<int, pieces::PIECES> s_PhaseValues{ 0, 1, 1, 2, 4, 0 };
+
+		using PieceSquareScores = std::array<std::array<std::array<PackedScore, BOARD_SQUARES>,
+				pieces::PIECES>, pieces::COLORS>;
+
+		// Material and piece-square values merged into one signed packed score per piece on square
+		const PieceSquareScores s_PieceSquareScores = []()
+		{
+			PieceSquareScores scores{};
+			for (int color = 0; color < pieces::COLORS; color++)
+			{
+				const int sign = (pieces::Color)color == pieces::Color::White ? 1 : -1;
+				for (int type = 0; type < pieces::PIECES; type++)
+				{
+					for (int square = 0; square < BOARD_SQUARES; square++)
+					{
+						const auto index = (pieces::Color)color == pieces::Color::White ?
+										   square : BOARD_SQUARES - 1 - square;
+						int earlyGame, endGame;
+						if ((pieces::Type)type == pieces::Type::King)
+						{
+							earlyGame = s_KingValuesEarlyGame[index];
+							endGame = s_KingValuesEndGame[index];
+						}
+						else
+						{
+							earlyGame = s_Values[type][index];
+							endGame = earlyGame;
+						}
+
+						earlyGame += s_MaterialValues[type];
+						endGame += s_MaterialValues[type];
+						scores[color][type][square] = PackedScore(earlyGame, endGame) * sign;
+					}
+				}
+			}
+
+			return scores;
+		}();
 	}
 
 	void IncrementalPieceSquareEvaluator::FeedRemoveAt(const Square square, const pieces::Piece piece)
 	{
-		Feed(square, piece, -1);
+		m_Score -= s_PieceSquareScores[(int)piece.color()][(int)piece.type()][square.value()];
+		m_Phase -= s_PhaseValues[(int)piece.type()];
 	}
 
 	void IncrementalPieceSquareEvaluator::FeedSetAt(const chess::core::Square square, const pieces::Piece piece)
 	{
-		Feed(square, piece, 1);
-	}
-
-	void IncrementalPieceSquareEvaluator::Feed(const chess::core::Square square,
-			const pieces::Piece piece, const int sign)
-	{
-		const auto index = piece.color() == pieces::Color::White ? square.value() : BOARD_SQUARES - 1 - square.value();
-		int earlyGameChange, endGameChange;
-
-		if (piece.type() == pieces::Type::King)
-		{
-			earlyGameChange = s_KingValuesEarlyGame[index];
-			endGameChange = s_KingValuesEndGame[index];
-		}
-		else
-		{
-			earlyGameChange = s_Values[(int)piece.type()][index];
-			endGameChange = earlyGameChange;
-		}
-
-		m_EarlyGameScores[(int)piece.color()] += earlyGameChange * sign;
-		m_EndGameScores[(int)piece.color()] += endGameChange * sign;
+		m_Score += s_PieceSquareScores[(int)piece.color()][(int)piece.type()][square.value()];
+		m_Phase += s_PhaseValues[(int)piece.type()];
 	}
 }
-
@@ -6,15 +6,34 @@
 
 #include <array>
 #include "../Common.h"
+#include "PackedScore.h"
 
 namespace chess::core::eval
 {
+	// Material, piece-square values and game phase, updated on every piece set or removed
 	class IncrementalPieceSquareEvaluator
 	{
 	public:
-		NODISCARD constexpr int GetScore(const pieces::Color color, const bool isEndGame) const
+		// Knights and bishops 1, rooks 2, queens 4: full starting material
+		static constexpr int MAX_PHASE = 24;
+
+		// Material and piece-square values, white minus black
+		NODISCARD constexpr PackedScore score() const
+		{
+			return m_Score;
+		}
+
+		// MAX_PHASE for a full board down to 0 for pawns and kings only, clamped after promotions
+		NODISCARD constexpr int phase() const
 		{
-			return isEndGame ? m_EndGameScores[(int)color] : m_EarlyGameScores[(int)color];
+			return m_Phase < MAX_PHASE ? m_Phase : MAX_PHASE;
+		}
+
+		// Interpolates between early and end game values by the current phase
+		NODISCARD constexpr int Blend(const PackedScore score) const
+		{
+			const auto phase = this->phase();
+			return (score.earlyGame() * phase + score.endGame() * (MAX_PHASE - phase)) / MAX_PHASE;
 		}
 
 		void FeedRemoveAt(Square square, pieces::Piece piece);
@@ -22,14 +41,12 @@ namespace chess::core::eval
 
 		void Reset()
 		{
-			m_EarlyGameScores.fill(0);
-			m_EndGameScores.fill(0);
+			m_Score = {};
+			m_Phase = 0;
 		}
 
 	private:
-		void Feed(Square square, pieces::Piece piece, int sign);
-
-		std::array<int, pieces::COLORS> m_EarlyGameScores{};
-		std::array<int, pieces::COLORS> m_EndGameScores{};
+		PackedScore m_Score{};
+		int m_Phase = 0;
 	};
 }
\ No newline at end of file
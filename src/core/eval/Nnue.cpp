@@ -0,0 +1,259 @@
+//
+// Created by matvey on 18.10.26.
+//
+
+#include "Nnue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CHESS_NNUE_X86
+#include <immintrin.h>
+#endif
+
+namespace chess::core::eval::nnue
+{
+	namespace
+	{
+		struct Network
+		{
+			alignas(32) std::array<std::array<int16_t, HIDDEN>, INPUTS> FeatureWeights;
+			alignas(32) std::array<int16_t, HIDDEN> FeatureBiases;
+			alignas(32) std::array<std::array<int16_t, HIDDEN>, pieces::COLORS> OutputWeights;
+			int16_t OutputBias;
+		};
+
+		constexpr size_t NETWORK_FILE_SIZE = sizeof(int16_t) * (INPUTS * HIDDEN + HIDDEN + 2 * HIDDEN + 1);
+		// Trainers pad the file to a multiple of 64 bytes
+		constexpr size_t NETWORK_FILE_PADDING = 64;
+
+		// Keep far below mate scores, the search treats those specially
+		constexpr int MAX_SCORE = 8000;
+
+		std::unique_ptr<Network> s_NetworkPtr;
+		std::atomic<const Network*> s_Network = nullptr;
+		// Shared by LockNetwork holders, exclusive while the network is replaced
+		std::shared_mutex s_NetworkMutex;
+
+#ifdef CHESS_NNUE_X86
+		const bool s_HasAvx2 = __builtin_cpu_supports("avx2");
+#endif
+
+		// Feature index as seen by perspective: own pieces first, squares flipped so each side plays "up" the board
+		constexpr int GetFeature(const pieces::Color perspective, const Square square, const pieces::Piece piece)
+		{
+			const int side = piece.color() == perspective ? 0 : 1;
+			const int relativeSquare = perspective == pieces::Color::White ? square.value() ^ 56 : square.value();
+			return (side * pieces::PIECES + (int)piece.type()) * BOARD_SQUARES + relativeSquare;
+		}
+
+		template<int Sign>
+		void UpdateScalar(int16_t* values, const int16_t* weights)
+		{
+			for (int i = 0; i < HIDDEN; i++)
+			{
+				values[i] = (int16_t)(values[i] + Sign * weights[i]);
+			}
+		}
+
+#ifdef CHESS_NNUE_X86
+		template<int Sign>
+		__attribute__((target("avx2"))) void UpdateAvx2(int16_t* values, const int16_t* weights)
+		{
+			for (int i = 0; i < HIDDEN; i += 16)
+			{
+				const auto value = _mm256_load_si256((const __m256i*)(values + i));
+				const auto weight = _mm256_load_si256((const __m256i*)(weights + i));
+				const auto result = Sign > 0 ? _mm256_add_epi16(value, weight) : _mm256_sub_epi16(value, weight);
+				_mm256_store_si256((__m256i*)(values + i), result);
+			}
+		}
+
+#endif
+
+		template<int Sign>
+		void Update(int16_t* values, const int16_t* weights)
+		{
+#ifdef CHESS_NNUE_X86
+			if (s_HasAvx2)
+			{
+				UpdateAvx2<Sign>(values, weights);
+				return;
+			}
+#endif
+			UpdateScalar<Sign>(values, weights);
+		}
+
+		// Squared clipped ReLU of (values + biases) dotted with the output weights, scaled by QA^2
+		int ForwardScalar(const int16_t* values, const int16_t* biases, const int16_t* weights)
+		{
+			int sum = 0;
+			for (int i = 0; i < HIDDEN; i++)
+			{
+				const int activation = std::clamp(values[i] + biases[i], 0, QA);
+				sum += activation * activation * weights[i];
+			}
+
+			return sum;
+		}
+
+#ifdef CHESS_NNUE_X86
+		__attribute__((target("avx2"))) int ForwardAvx2(const int16_t* values, const int16_t* biases,
+				const int16_t* weights)
+		{
+			const auto zero = _mm256_setzero_si256();
+			const auto max = _mm256_set1_epi16(QA);
+
+			auto sum = _mm256_setzero_si256();
+			for (int i = 0; i < HIDDEN; i += 16)
+			{
+				const auto value = _mm256_load_si256((const __m256i*)(values + i));
+				const auto bias = _mm256_load_si256((const __m256i*)(biases + i));
+				const auto weight = _mm256_load_si256((const __m256i*)(weights + i));
+
+				const auto activation = _mm256_min_epi16(_mm256_max_epi16(_mm256_add_epi16(value, bias), zero), max);
+				// activation * weight fits int16 while |weight| <= 128, the second factor is widened by madd
+				sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_mullo_epi16(activation, weight), activation));
+			}
+
+			const auto half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+			const auto quarter = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0b01001110));
+			const auto eighth = _mm_add_epi32(quarter, _mm_shuffle_epi32(quarter, 0b10110001));
+			return _mm_cvtsi128_si32(eighth);
+		}
+
+#endif
+
+		int Forward(const int16_t* values, const int16_t* biases, const int16_t* weights)
+		{
+#ifdef CHESS_NNUE_X86
+			if (s_HasAvx2)
+			{
+				return ForwardAvx2(values, biases, weights);
+			}
+#endif
+			return ForwardScalar(values, biases, weights);
+		}
+	}
+
+	void Accumulator::FeedRemoveAt(const Square square, const pieces::Piece piece)
+	{
+		const auto* network = s_Network.load(std::memory_order_relaxed);
+		for (int perspective = 0; perspective < pieces::COLORS; perspective++)
+		{
+			const auto feature = GetFeature((pieces::Color)perspective, square, piece);
+			Update<-1>(m_Values[perspective].data(), network->FeatureWeights[feature].data());
+		}
+	}
+
+	void Accumulator::FeedSetAt(const Square square, const pieces::Piece piece)
+	{
+		const auto* network = s_Network.load(std::memory_order_relaxed);
+		for (int perspective = 0; perspective < pieces::COLORS; perspective++)
+		{
+			const auto feature = GetFeature((pieces::Color)perspective, square, piece);
+			Update<1>(m_Values[perspective].data(), network->FeatureWeights[feature].data());
+		}
+	}
+
+	void Accumulator::Refresh(const std::array<pieces::Piece, BOARD_SQUARES>& pieces)
+	{
+		Reset();
+		if (!IsLoaded())
+		{
+			return;
+		}
+
+		for (int square = 0; square < BOARD_SQUARES; square++)
+		{
+			if (pieces[square].IsValid())
+			{
+				FeedSetAt(Square(square), pieces[square]);
+			}
+		}
+	}
+
+	bool LoadNetwork(const std::string_view path)
+	{
+		std::ifstream fin(std::string(path), std::ios::binary | std::ios::ate);
+		if (!fin)
+		{
+			std::cout << "Network " << path << " not found\n";
+			return false;
+		}
+
+		const auto size = (size_t)fin.tellg();
+		if (size < NETWORK_FILE_SIZE || size >= NETWORK_FILE_SIZE + NETWORK_FILE_PADDING)
+		{
+			std::cout << "Network " << path << " has unexpected size " << size << ", expected "
+					  << NETWORK_FILE_SIZE << '\n';
+			return false;
+		}
+
+		std::vector<char> buffer(NETWORK_FILE_SIZE);
+		fin.seekg(0);
+		fin.read(buffer.data(), (std::streamsize)buffer.size());
+		if (!fin)
+		{
+			std::cout << "Failed to read network " << path << '\n';
+			return false;
+		}
+
+		auto network = std::make_unique<Network>();
+		auto* it = buffer.data();
+		const auto read = [&it](void* destination, const size_t bytes)
+		{
+			std::memcpy(destination, it, bytes);
+			it += bytes;
+		};
+
+		read(network->FeatureWeights.data(), sizeof(network->FeatureWeights));
+		read(network->FeatureBiases.data(), sizeof(network->FeatureBiases));
+		read(network->OutputWeights.data(), sizeof(network->OutputWeights));
+		read(&network->OutputBias, sizeof(network->OutputBias));
+
+		std::unique_lock lock(s_NetworkMutex);
+		s_Network = network.get();
+		s_NetworkPtr = std::move(network);
+		return true;
+	}
+
+	void UnloadNetwork()
+	{
+		std::unique_lock lock(s_NetworkMutex);
+		s_Network = nullptr;
+		s_NetworkPtr.reset();
+	}
+
+	std::shared_lock<std::shared_mutex> LockNetwork()
+	{
+		return std::shared_lock(s_NetworkMutex);
+	}
+
+	bool IsLoaded()
+	{
+		return s_Network.load(std::memory_order_relaxed) != nullptr;
+	}
+
+	int Evaluate(const Accumulator& accumulator, const pieces::Color colorToPlay)
+	{
+		const auto* network = s_Network.load(std::memory_order_relaxed);
+		assert(network);
+
+		const auto them = pieces::OppositeColor(colorToPlay);
+		const auto* biases = network->FeatureBiases.data();
+
+		int64_t sum = Forward(accumulator.GetValues(colorToPlay), biases, network->OutputWeights[0].data());
+		sum += Forward(accumulator.GetValues(them), biases, network->OutputWeights[1].data());
+
+		const auto output = (sum / QA + network->OutputBias) * SCALE / (QA * QB);
+		return (int)std::clamp<int64_t>(output, -MAX_SCORE, MAX_SCORE);
+	}
+}
@@ -0,0 +1,63 @@
+//
+// Created by matvey on 18.10.26.
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <shared_mutex>
+#include "../Common.h"
+
+namespace chess::core::eval::nnue
+{
+	// (768 -> HIDDEN) x 2 -> 1 network: one input per piece type, color and square, seen from both sides.
+	// Layout and quantisation follow the common "simple" trainer format:
+	// int16 feature weights [768][HIDDEN], feature biases [HIDDEN], output weights [2 * HIDDEN], output bias
+	constexpr int INPUTS = pieces::COLORS * pieces::PIECES * BOARD_SQUARES;
+	constexpr int HIDDEN = 256;
+
+	constexpr int QA = 255;
+	constexpr int QB = 64;
+	constexpr int SCALE = 400;
+
+	// Sums of active feature weights for both perspectives, biases are added on evaluation
+	class Accumulator
+	{
+	public:
+		void FeedRemoveAt(Square square, pieces::Piece piece);
+		void FeedSetAt(Square square, pieces::Piece piece);
+
+		void Refresh(const std::array<pieces::Piece, BOARD_SQUARES>& pieces);
+
+		void Reset()
+		{
+			for (auto& values : m_Values)
+			{
+				values.fill(0);
+			}
+		}
+
+		NODISCARD constexpr const int16_t* GetValues(const pieces::Color perspective) const
+		{
+			return m_Values[(int)perspective].data();
+		}
+
+	private:
+		alignas(32) std::array<std::array<int16_t, HIDDEN>, pieces::COLORS> m_Values{};
+	};
+
+	// Replaces the active network, keeps the previous one if the file is missing or malformed.
+	// Waits until no LockNetwork holder is left, accumulators built before have to be refreshed
+	bool LoadNetwork(std::string_view path);
+	void UnloadNetwork();
+
+	// Held for as long as boards are moved or evaluated, across a whole search or batch.
+	// The network can not be replaced or freed meanwhile
+	NODISCARD std::shared_lock<std::shared_mutex> LockNetwork();
+	NODISCARD bool IsLoaded();
+
+	// Side to move relative score in centipawns
+	NODISCARD int Evaluate(const Accumulator& accumulator, pieces::Color colorToPlay);
+}
@@ -0,0 +1,83 @@
+//
+// Created by matvey on 18.10.26.
+//
+
+#pragma once
+
+#include <cstdint>
+#include "../Common.h"
+
+namespace chess::core::eval
+{
+	// Early game and end game values packed into one integer, so both are updated with a single add.
+	// End game lives in the upper 16 bits, early game in the lower 16 bits (borrowing from the upper half)
+	struct PackedScore
+	{
+	public:
+		constexpr PackedScore() = default;
+
+		constexpr PackedScore(const int earlyGame, const int endGame)
+				:m_Value((int)((unsigned)endGame << 16) + earlyGame)
+		{
+		}
+
+		NODISCARD constexpr int earlyGame() const
+		{
+			return (int16_t)(uint16_t)(unsigned)m_Value;
+		}
+
+		NODISCARD constexpr int endGame() const
+		{
+			return (int16_t)(uint16_t)((unsigned)(m_Value + 0x8000) >> 16);
+		}
+
+		constexpr PackedScore& operator+=(const PackedScore rhs)
+		{
+			m_Value += rhs.m_Value;
+			return *this;
+		}
+
+		constexpr PackedScore& operator-=(const PackedScore rhs)
+		{
+			m_Value -= rhs.m_Value;
+			return *this;
+		}
+
+		NODISCARD constexpr PackedScore operator+(const PackedScore rhs) const
+		{
+			auto copy = *this;
+			return copy += rhs;
+		}
+
+		NODISCARD constexpr PackedScore operator-(const PackedScore rhs) const
+		{
+			auto copy = *this;
+			return copy -= rhs;
+		}
+
+		NODISCARD constexpr PackedScore operator-() const
+		{
+			return FromRaw(-m_Value);
+		}
+
+		NODISCARD constexpr PackedScore operator*(const int multiplier) const
+		{
+			return FromRaw(m_Value * multiplier);
+		}
+
+		NODISCARD constexpr bool operator==(const PackedScore rhs) const
+		{
+			return m_Value == rhs.m_Value;
+		}
+
+	private:
+		static constexpr PackedScore FromRaw(const int value)
+		{
+			PackedScore score;
+			score.m_Value = value;
+			return score;
+		}
+
+		int m_Value = 0;
+	};
+}
@@ -0,0 +1,120 @@
+//
+// Created by matvey on 18.10.26.
+//
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <utility>
+#include "Cuckoo.h"
+#include "Zobrist.h"
+
+namespace chess::core::hash::cuckoo
+{
+	namespace
+	{
+		constexpr int TABLE_SIZE = 8192;
+		// Reversible moves of every non-pawn piece on an empty board
+		constexpr int MOVE_COUNT = 3668;
+
+		constexpr int GetFirstIndex(const uint64_t key)
+		{
+			return (int)(key & (TABLE_SIZE - 1));
+		}
+
+		constexpr int GetSecondIndex(const uint64_t key)
+		{
+			return (int)((key >> 16) & (TABLE_SIZE - 1));
+		}
+
+		// Empty board reach, the table is built before the lookups are
+		bool CanMove(const pieces::Type type, const Square from, const Square to)
+		{
+			const int fileDistance = std::abs(from.file() - to.file());
+			const int rankDistance = std::abs(from.rank() - to.rank());
+			const bool isDiagonal = fileDistance == rankDistance;
+			const bool isOrthogonal = fileDistance == 0 || rankDistance == 0;
+
+			switch (type)
+			{
+			case pieces::Type::Knight:
+				return fileDistance * rankDistance == 2;
+			case pieces::Type::Bishop:
+				return isDiagonal;
+			case pieces::Type::Rook:
+				return isOrthogonal;
+			case pieces::Type::Queen:
+				return isDiagonal || isOrthogonal;
+			case pieces::Type::King:
+				return std::max(fileDistance, rankDistance) == 1;
+			default:
+				return false;
+			}
+		}
+
+		std::array<uint64_t, TABLE_SIZE> s_Keys{};
+		std::array<moves::Move, TABLE_SIZE> s_Moves;
+
+		struct Initializer
+		{
+			Initializer()
+			{
+				[[maybe_unused]] int count = 0;
+
+				for (int color = 0; color < pieces::COLORS; color++)
+				{
+					for (int type = (int)pieces::Type::Knight; type <= (int)pieces::Type::King; type++)
+					{
+						const pieces::Piece piece((pieces::Color)color, (pieces::Type)type);
+						for (int from = 0; from < BOARD_SQUARES; from++)
+						{
+							for (int to = from + 1; to < BOARD_SQUARES; to++)
+							{
+								if (!CanMove(piece.type(), Square(from), Square(to)))
+								{
+									continue;
+								}
+
+								auto key = ZobristHash::GetPieceKey(Square(from), piece)
+										^ ZobristHash::GetPieceKey(Square(to), piece)
+										^ ZobristHash::GetColorToPlayKey();
+								auto move = moves::Move(Square(from), Square(to), moves::Type::Quiet);
+
+								// Cuckoo insertion: the evicted entry moves to its other slot
+								int index = GetFirstIndex(key);
+								while (true)
+								{
+									std::swap(s_Keys[index], key);
+									std::swap(s_Moves[index], move);
+									if (!move.IsValid())
+									{
+										break;
+									}
+									index = index == GetFirstIndex(key) ? GetSecondIndex(key) : GetFirstIndex(key);
+								}
+								count++;
+							}
+						}
+					}
+				}
+
+				assert(count == MOVE_COUNT);
+			}
+		};
+
+		Initializer s_Initializer;
+	}
+
+	moves::Move FindMove(const uint64_t moveKey)
+	{
+		if (s_Keys[GetFirstIndex(moveKey)] == moveKey)
+		{
+			return s_Moves[GetFirstIndex(moveKey)];
+		}
+		if (s_Keys[GetSecondIndex(moveKey)] == moveKey)
+		{
+			return s_Moves[GetSecondIndex(moveKey)];
+		}
+		return moves::Move::Empty();
+	}
+}
@@ -0,0 +1,15 @@
+//
+// Created by matvey on 18.10.26.
+//
+
+#pragma once
+
+#include "../Common.h"
+#include "../moves/Move.h"
+
+namespace chess::core::hash::cuckoo
+{
+	// Every move of a knight, bishop, rook, queen or king between two squares, keyed by the hash difference
+	// it makes. Empty when no such move changes the hash by moveKey
+	NODISCARD moves::Move FindMove(uint64_t moveKey);
+}
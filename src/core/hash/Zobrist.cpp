@@ -226,13 +226,26 @@ namespace chess::core::hash
 	}
 
 	void ZobristHash::TogglePiece(const Square square, const pieces::Piece piece)
+	{
+		m_Value ^= GetPieceKey(square, piece);
+	}
+
+	uint64_t ZobristHash::GetPieceKey(const Square square, const pieces::Piece piece)
 	{
 		assert(piece.IsValid());
 		const auto pieceKind = pieces::COLORS * (int)piece.type() + (piece.color() == pieces::Color::White);
-		m_Value ^= polyglot::Random64[BOARD_SQUARES * pieceKind + BOARD_SIZE * (BOARD_SIZE - square.rank() - 1)
+		return polyglot::Random64[BOARD_SQUARES * pieceKind + BOARD_SIZE * (BOARD_SIZE - square.rank() - 1)
 				+ square.file()];
 	}
 
+	void ZobristHash::ToggleMaterial(const pieces::Piece piece, const int count)
+	{
+		assert(piece.IsValid());
+		assert(0 <= count && count < BOARD_SQUARES);
+		const auto pieceKind = pieces::COLORS * (int)piece.type() + (piece.color() == pieces::Color::White);
+		m_Value ^= polyglot::Random64[BOARD_SQUARES * pieceKind + count];
+	}
+
 	void ZobristHash::ToggleCastlingRights(const pieces::CastlingRights castlingRights)
 	{
 		static constexpr int CASTLE_OFFSET = 768;
@@ -256,8 +269,13 @@ namespace chess::core::hash
 	}
 
 	void ZobristHash::ToggleColorToPlay()
+	{
+		m_Value ^= GetColorToPlayKey();
+	}
+
+	uint64_t ZobristHash::GetColorToPlayKey()
 	{
 		static constexpr int TURN_OFFSET = 780;
-		m_Value ^= polyglot::Random64[TURN_OFFSET];
+		return polyglot::Random64[TURN_OFFSET];
 	}
 }
\ No newline at end of file
@@ -15,6 +15,11 @@ namespace chess::core::hash
 		void TogglePiece(Square square, pieces::Piece piece);
 		void ToggleEpFile(int file);
 		void ToggleCastlingRights(pieces::CastlingRights castlingRights);
+		// Material signature: toggled for the count-th piece of a kind as it appears or disappears
+		void ToggleMaterial(pieces::Piece piece, int count);
+
+		NODISCARD static uint64_t GetPieceKey(Square square, pieces::Piece piece);
+		NODISCARD static uint64_t GetColorToPlayKey();
 
 		constexpr void Reset()
 		{
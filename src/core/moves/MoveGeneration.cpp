@@ -415,6 +415,80 @@ namespace chess::core::moves
 			   lookups::GetInBetween(checkerSquare, kingSquare) : Bitboard();
 	}
 
+	namespace
+	{
+		// Largest number of moves a single non-king piece can produce (queen on an open board)
+		static constexpr int MAX_PIECE_MOVES = 32;
+
+		struct MoveMasks
+		{
+			Bitboard Push;
+			Bitboard Capture;
+			Bitboard PawnPush;
+		};
+
+		MoveMasks GetMoveMasks(const Board& board)
+		{
+			const auto checkersBB = board.checkers();
+			const auto us = board.colorToPlay();
+
+			Bitboard pushMask{ ~0ULL };
+			Bitboard captureMask{ ~0ULL };
+
+			if (checkersBB)
+			{
+				const auto kingSquare = board.GetKingSquare(us);
+				captureMask = checkersBB;
+				const auto checker = Square(checkersBB.BitScanForward());
+				pushMask = GeneratePushMaskFromChecker(board, checker, kingSquare);
+			}
+
+			const auto freeBB = ~board.occupancy();
+			const auto ourPawnsBB = board.GetPieces(us, pieces::Type::Pawn);
+			const auto canDoublePushRank = lookups::GetRank(us == pieces::Color::Black ? 1 : 6);
+
+			static constexpr auto shiftLeft = [](const Bitboard value, const int shift)
+			{
+				return shift >= 0 ? value << shift : value >> -shift;
+			};
+
+			const int shift = us == pieces::Color::Black ? 8 : -8;
+
+			const auto pawnsSinglePushMask = shiftLeft(ourPawnsBB, shift) & freeBB;
+			auto pawnsDoublePushMask = shiftLeft(ourPawnsBB & canDoublePushRank, shift) & freeBB;
+			pawnsDoublePushMask = shiftLeft(pawnsDoublePushMask, shift) & freeBB;
+
+			return {
+					.Push = pushMask,
+					.Capture = captureMask,
+					.PawnPush = pushMask & (pawnsSinglePushMask | pawnsDoublePushMask)
+			};
+		}
+
+		template<bool CapturesOnly>
+		Move* GeneratePieceMoves(const Board& board, const Square square, const pieces::Type type,
+				const MoveMasks& masks, Move* output)
+		{
+			switch (type)
+			{
+			case pieces::Type::Pawn:
+				return GeneratePawnMoves<CapturesOnly>(board, square, output, masks.PawnPush, masks.Capture);
+			case pieces::Type::Knight:
+				return GenerateKnightMoves<CapturesOnly>(board, square, output, masks.Push, masks.Capture);
+			case pieces::Type::Bishop:
+				return GenerateBishopMoves<CapturesOnly>(board, square, output, masks.Push, masks.Capture);
+			case pieces::Type::Rook:
+				return GenerateRookMoves<CapturesOnly>(board, square, output, masks.Push, masks.Capture);
+			case pieces::Type::Queen:
+				return GenerateQueenMoves<CapturesOnly>(board, square, output, masks.Push, masks.Capture);
+			case pieces::Type::King:
+				return GenerateKingMoves<CapturesOnly>(board, square, output);
+			}
+
+			return output;
+		}
+	}
+
 	template<Legality Legality, bool CapturesOnly>
 	TypedMove* GenerateMoves(const Board& board, TypedMove* output)
 	{
@@ -436,99 +510,63 @@ namespace chess::core::moves
 		static_assert(Legality == Legality::PseudoLegal || Legality == Legality::Legal);
 		assert(output);
 
-		auto outputEndCopy = output;
-
-		const auto checkersBB = board.checkers();
-		const auto checkersCount = checkersBB.PopCount();
-
 		const auto us = board.colorToPlay();
 
-		if (checkersCount > 1)
+		if (board.checkers().PopCount() > 1)
 		{
 			const auto kingSquare = board.GetKingSquare(us);
 			return GenerateKingMoves<false>(board, kingSquare, output);
 		}
 
-		Bitboard pushMask{ ~0ULL };
-		Bitboard captureMask{ ~0ULL };
+		const auto masks = GetMoveMasks(board);
+
+		Square pieces[16];
+		const auto piecesBB = board.GetPieces(us);
+		const auto end = piecesBB.BitScanForwardAll(pieces);
 
-		if (checkersCount == 1)
+		for (auto it = pieces; it != end; it++)
 		{
-			const auto kingSquare = board.GetKingSquare(us);
-			captureMask = checkersBB;
-			const auto checker = Square(checkersBB.BitScanForward());
-			pushMask = GeneratePushMaskFromChecker(board, checker, kingSquare);
+			output = GeneratePieceMoves<CapturesOnly>(board, *it, board.GetPiece(*it).type(), masks, output);
 		}
 
-		const auto freeBB = ~board.occupancy();
-		const auto ourPawnsBB = board.GetPieces(us, pieces::Type::Pawn);
-		const auto canDoublePushRank = lookups::GetRank(us == pieces::Color::Black ? 1 : 6);
+		return output;
+	}
 
-		Bitboard pawnPushMask;
+	bool HasLegalMove(const Board& board)
+	{
+		const auto us = board.colorToPlay();
+		const auto kingSquare = board.GetKingSquare(us);
 
-		static constexpr auto shiftLeft = [](const Bitboard value, const int shift)
+		// Attacked squares are computed with the king removed, so any such square is a legal king move.
+		// Castling is skipped: it is only possible when the king can also step onto the adjacent square.
+		const auto kingMovesBB = lookups::GetKingMoves(kingSquare)
+				& ~board.GetAttacked(pieces::OppositeColor(us)) & ~board.GetPieces(us);
+		if (kingMovesBB)
 		{
-			return shift >= 0 ? value << shift : value >> -shift;
-		};
+			return true;
+		}
 
-		const int shift = us == pieces::Color::Black ? 8 : -8;
+		if (board.checkers().PopCount() > 1)
+		{
+			return false;
+		}
 
-		const auto pawnsSinglePushMask = shiftLeft(ourPawnsBB, shift) & freeBB;
-		auto pawnsDoublePushMask = shiftLeft(ourPawnsBB & canDoublePushRank, shift) & freeBB;
-		pawnsDoublePushMask = shiftLeft(pawnsDoublePushMask, shift) & freeBB;
-		pawnPushMask = pushMask & (pawnsSinglePushMask | pawnsDoublePushMask);
+		const auto masks = GetMoveMasks(board);
 
 		Square pieces[16];
-		const auto piecesBB = board.GetPieces(us);
+		const auto piecesBB = board.GetPieces(us).WithReset(kingSquare);
 		const auto end = piecesBB.BitScanForwardAll(pieces);
 
+		Move moves[MAX_PIECE_MOVES];
 		for (auto it = pieces; it != end; it++)
 		{
-			const auto piece = board.GetPiece(*it);
-			switch (piece.type())
+			if (GeneratePieceMoves<false>(board, *it, board.GetPiece(*it).type(), masks, moves) != moves)
 			{
-			case pieces::Type::Pawn:
-				output = GeneratePawnMoves<CapturesOnly>(board, *it, output, pawnPushMask, captureMask);
-				break;
-			case pieces::Type::Knight:
-				output = GenerateKnightMoves<CapturesOnly>(board, *it, output, pushMask, captureMask);
-				break;
-			case pieces::Type::Bishop:
-				output = GenerateBishopMoves<CapturesOnly>(board, *it, output, pushMask, captureMask);
-				break;
-			case pieces::Type::Rook:
-				output = GenerateRookMoves<CapturesOnly>(board, *it, output, pushMask, captureMask);
-				break;
-			case pieces::Type::Queen:
-				output = GenerateQueenMoves<CapturesOnly>(board, *it, output, pushMask, captureMask);
-				break;
-			case pieces::Type::King:
-				output = GenerateKingMoves<CapturesOnly>(board, *it, output);
-				break;
+				return true;
 			}
 		}
 
-//		if constexpr (Legality == Legality::Legal)
-//		{
-//			Move legalMoves[MAX_MOVES];
-//			auto legalMovesEnd = legalMoves;
-//			for (auto it = outputEndCopy; it != output; it++)
-//			{
-//				if (board.IsLegal(*it))
-//				{
-//					*legalMovesEnd++ = *it;
-//				}
-//			}
-//
-//			for (auto it = legalMoves; it != legalMovesEnd; it++)
-//			{
-//				*outputEndCopy++ = *it;
-//			}
-//
-//			return outputEndCopy;
-//		}
-
-		return output;
+		return false;
 	}
 
 	TypedMove GetTypedMove(const Board& board, const Move move)
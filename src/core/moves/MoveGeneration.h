@@ -22,4 +22,7 @@ namespace chess::core::moves
 	Move* GenerateMoves(const Board& board, Move* output);
 
 	NODISCARD TypedMove GetTypedMove(const Board& board, Move move);
+
+	// Stops at the first legal move found, cheaper than a full generation for mate/stalemate tests
+	NODISCARD bool HasLegalMove(const Board& board);
 }
\ No newline at end of file
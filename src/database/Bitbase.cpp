@@ -0,0 +1,1163 @@
+//
+// Created by matvey on 18.10.26.
+//
+
+#include "Bitbase.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "../core/Magic.h"
+#include "../core/ScopedTimer.h"
+
+namespace chess::database::bitbase
+{
+	using namespace core;
+
+	namespace
+	{
+		constexpr uint32_t FILE_MAGIC = 0x42424343;
+		constexpr uint32_t FILE_VERSION = 1;
+
+		struct FileHeader
+		{
+			uint32_t Magic;
+			uint32_t Version;
+			uint32_t Endings;
+			uint32_t Words;
+		};
+
+		template<typename F>
+		bool ForEachChunk(const int threadCount, const int count, const F& function)
+		{
+			std::atomic_bool changed = false;
+			std::vector<std::thread> threads;
+			const int chunk = count / threadCount;
+			for (int i = 0; i < threadCount; i++)
+			{
+				const int begin = i * chunk;
+				const int end = i + 1 == threadCount ? count : begin + chunk;
+				threads.emplace_back([&function, &changed, begin, end]()
+				{
+					if (function(begin, end))
+					{
+						changed = true;
+					}
+				});
+			}
+
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+
+			return changed;
+		}
+
+		// Null if the file is missing or holds other tables. The mapping is kept for the process lifetime
+		const uint64_t* TryMap(const std::filesystem::path& path, const uint32_t endings, const uint32_t words)
+		{
+			const size_t fileSize = sizeof(FileHeader) + sizeof(uint64_t) * words * endings;
+
+			std::error_code error;
+			if (std::filesystem::file_size(path, error) != fileSize || error)
+			{
+				return nullptr;
+			}
+
+			const int fd = open(path.c_str(), O_RDONLY);
+			if (fd < 0)
+			{
+				return nullptr;
+			}
+
+			auto* mapping = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+			close(fd);
+			if (mapping == MAP_FAILED)
+			{
+				return nullptr;
+			}
+
+			const auto* header = (const FileHeader*)mapping;
+			if (header->Magic != FILE_MAGIC || header->Version != FILE_VERSION || header->Endings != endings
+					|| header->Words != words)
+			{
+				munmap(mapping, fileSize);
+				return nullptr;
+			}
+
+			return (const uint64_t*)((const char*)mapping + sizeof(FileHeader));
+		}
+
+		void Store(const std::filesystem::path& path, const uint32_t endings, const uint32_t words,
+				const std::vector<uint64_t>& tables)
+		{
+			// Written aside and renamed, so a concurrent reader never maps a partial file
+			auto temporaryPath = path;
+			temporaryPath += ".tmp";
+
+			{
+				std::ofstream fout(temporaryPath, std::ios::binary);
+				const FileHeader header{ FILE_MAGIC, FILE_VERSION, endings, words };
+				fout.write((const char*)&header, sizeof(header));
+				fout.write((const char*)tables.data(), (std::streamsize)(tables.size() * sizeof(uint64_t)));
+				if (!fout)
+				{
+					std::cout << "Failed to store bitbases to " << path << '\n';
+					return;
+				}
+			}
+
+			std::error_code error;
+			std::filesystem::rename(temporaryPath, path, error);
+		}
+
+		// Rook and queen first, pawn promotions look them up
+		enum Ending
+		{
+			KRK, KQK, KPK, ENDINGS
+		};
+
+		constexpr std::array<pieces::Type, ENDINGS> ENDING_PIECES{
+				pieces::Type::Rook, pieces::Type::Queen, pieces::Type::Pawn
+		};
+
+		// Side to move, strong king, weak king, piece. The strong side is always normalised to white
+		constexpr int POSITIONS = pieces::COLORS * BOARD_SQUARES * BOARD_SQUARES * BOARD_SQUARES;
+		constexpr int WORDS = POSITIONS / 64;
+
+		constexpr std::string_view FILE_NAME = "bitbases.bin";
+
+		constexpr int GetIndex(const bool strongToMove, const int strongKing, const int weakKing, const int piece)
+		{
+			return (((strongToMove ? 0 : 1) * BOARD_SQUARES + strongKing) * BOARD_SQUARES + weakKing) * BOARD_SQUARES
+					+ piece;
+		}
+
+		// One bit per position, set when the strong side wins
+		using Table = const uint64_t*;
+
+		bool IsWin(const Table table, const int index)
+		{
+			return (table[index / 64] >> (index % 64)) & 1;
+		}
+
+		std::array<Table, ENDINGS> s_Tables{};
+		std::vector<uint64_t> s_Generated;
+
+		std::mutex s_InitMutex;
+		std::atomic_bool s_Ready = false;
+
+		enum struct State : uint8_t
+		{
+			Invalid, Unknown, Draw, Win
+		};
+
+		// Iterates "strong side to move wins if some move wins, weak side loses if every move loses"
+		// until nothing changes, everything left undecided is a draw
+		class Generator
+		{
+		public:
+			Generator(const Ending ending, const std::array<Table, ENDINGS>& tables)
+					:m_Piece(ENDING_PIECES[ending]), m_Tables(tables), m_States(POSITIONS)
+			{
+			}
+
+			void Run(const int threadCount)
+			{
+				ForEachChunk(threadCount, POSITIONS, [this](const int begin, const int end)
+				{
+					for (int index = begin; index < end; index++)
+					{
+						m_States[index].store(Initialize(index), std::memory_order_relaxed);
+					}
+					return false;
+				});
+
+				while (ForEachChunk(threadCount, POSITIONS, [this](const int begin, const int end)
+				{
+					bool changed = false;
+					for (int index = begin; index < end; index++)
+					{
+						if (m_States[index].load(std::memory_order_relaxed) != State::Unknown)
+						{
+							continue;
+						}
+
+						const auto state = Classify(index);
+						if (state != State::Unknown)
+						{
+							m_States[index].store(state, std::memory_order_relaxed);
+							changed = true;
+						}
+					}
+					return changed;
+				}))
+				{
+				}
+			}
+
+			void Pack(uint64_t* output) const
+			{
+				std::memset(output, 0, sizeof(uint64_t) * WORDS);
+				for (int index = 0; index < POSITIONS; index++)
+				{
+					if (m_States[index].load(std::memory_order_relaxed) == State::Win)
+					{
+						output[index / 64] |= 1ULL << (index % 64);
+					}
+				}
+			}
+
+		private:
+			NODISCARD Bitboard GetPieceAttacks(const Square square, const Bitboard occupancy) const
+			{
+				switch (m_Piece)
+				{
+				case pieces::Type::Pawn:
+					return lookups::GetPawnAttacks(square, pieces::Color::White);
+				case pieces::Type::Rook:
+					return lookups::GetSliderMoves<pieces::Type::Rook>(square, occupancy);
+				default:
+					return lookups::GetSliderMoves<pieces::Type::Queen>(square, occupancy);
+				}
+			}
+
+			// Squares the lone king may step to, including a capture of the undefended piece
+			NODISCARD Bitboard GetWeakKingMoves(const Square strongKing, const Square weakKing,
+					const Square piece) const
+			{
+				// The weak king does not block attacks along the line it is moving on
+				const auto occupancy = Bitboard().WithSet(strongKing).WithSet(piece);
+				return lookups::GetKingMoves(weakKing) & ~lookups::GetKingMoves(strongKing)
+						& ~GetPieceAttacks(piece, occupancy);
+			}
+
+			NODISCARD State Initialize(const int index) const
+			{
+				const bool strongToMove = index < POSITIONS / 2;
+				const auto piece = Square(index % BOARD_SQUARES);
+				const auto weakKing = Square(index / BOARD_SQUARES % BOARD_SQUARES);
+				const auto strongKing = Square(index / (BOARD_SQUARES * BOARD_SQUARES) % BOARD_SQUARES);
+
+				if (piece == weakKing || piece == strongKing || weakKing == strongKing
+						|| lookups::GetKingMoves(strongKing).TestAt(weakKing))
+				{
+					return State::Invalid;
+				}
+				if (m_Piece == pieces::Type::Pawn && (piece.rank() == 0 || piece.rank() == BOARD_SIZE - 1))
+				{
+					return State::Invalid;
+				}
+
+				const auto occupancy = Bitboard().WithSet(strongKing).WithSet(weakKing).WithSet(piece);
+				const bool weakInCheck = GetPieceAttacks(piece, occupancy).TestAt(weakKing);
+				if (strongToMove)
+				{
+					return weakInCheck ? State::Invalid : State::Unknown;
+				}
+
+				const auto moves = GetWeakKingMoves(strongKing, weakKing, piece);
+				if (moves.TestAt(piece))
+				{
+					// King against king
+					return State::Draw;
+				}
+				if (!moves)
+				{
+					return weakInCheck ? State::Win : State::Draw;
+				}
+
+				return State::Unknown;
+			}
+
+			NODISCARD State Classify(const int index) const
+			{
+				const bool strongToMove = index < POSITIONS / 2;
+				const auto piece = Square(index % BOARD_SQUARES);
+				const auto weakKing = Square(index / BOARD_SQUARES % BOARD_SQUARES);
+				const auto strongKing = Square(index / (BOARD_SQUARES * BOARD_SQUARES) % BOARD_SQUARES);
+
+				if (!strongToMove)
+				{
+					bool allWin = true;
+					auto moves = GetWeakKingMoves(strongKing, weakKing, piece);
+					while (moves)
+					{
+						const auto state = Get(true, strongKing.value(), moves.PopFirstSetBit(), piece.value());
+						if (state == State::Draw)
+						{
+							return State::Draw;
+						}
+						allWin &= state == State::Win;
+					}
+
+					return allWin ? State::Win : State::Unknown;
+				}
+
+				bool allDraw = true;
+				const auto consider = [&allDraw](const State state)
+				{
+					allDraw &= state == State::Draw;
+					return state == State::Win;
+				};
+
+				auto kingMoves = lookups::GetKingMoves(strongKing) & ~lookups::GetKingMoves(weakKing)
+						& ~Bitboard().WithSet(piece);
+				while (kingMoves)
+				{
+					if (consider(Get(false, kingMoves.PopFirstSetBit(), weakKing.value(), piece.value())))
+					{
+						return State::Win;
+					}
+				}
+
+				const auto occupancy = Bitboard().WithSet(strongKing).WithSet(weakKing).WithSet(piece);
+				if (m_Piece != pieces::Type::Pawn)
+				{
+					auto pieceMoves = GetPieceAttacks(piece, occupancy) & ~occupancy;
+					while (pieceMoves)
+					{
+						if (consider(Get(false, strongKing.value(), weakKing.value(), pieceMoves.PopFirstSetBit())))
+						{
+							return State::Win;
+						}
+					}
+
+					return allDraw ? State::Draw : State::Unknown;
+				}
+
+				const auto push = Square(piece.value() - BOARD_SIZE);
+				if (!occupancy.TestAt(push))
+				{
+					if (push.rank() == 0)
+					{
+						// Under promotion to a rook avoids some stalemates
+						const auto promotionIndex = GetIndex(false, strongKing.value(), weakKing.value(), push.value());
+						if (IsWin(m_Tables[KQK], promotionIndex) || IsWin(m_Tables[KRK], promotionIndex))
+						{
+							return State::Win;
+						}
+					}
+					else
+					{
+						if (consider(Get(false, strongKing.value(), weakKing.value(), push.value())))
+						{
+							return State::Win;
+						}
+
+						const auto doublePush = Square(push.value() - BOARD_SIZE);
+						if (piece.rank() == BOARD_SIZE - 2 && !occupancy.TestAt(doublePush)
+								&& consider(Get(false, strongKing.value(), weakKing.value(), doublePush.value())))
+						{
+							return State::Win;
+						}
+					}
+				}
+
+				return allDraw ? State::Draw : State::Unknown;
+			}
+
+			NODISCARD State Get(const bool strongToMove, const int strongKing, const int weakKing,
+					const int piece) const
+			{
+				return m_States[GetIndex(strongToMove, strongKing, weakKing, piece)].load(std::memory_order_relaxed);
+			}
+
+			pieces::Type m_Piece;
+			const std::array<Table, ENDINGS>& m_Tables;
+			std::vector<std::atomic<State>> m_States;
+		};
+
+		void Generate(const int threadCount)
+		{
+			utils::ScopedTimer timer(__FILE__, true);
+
+			s_Generated.assign((size_t)WORDS * ENDINGS, 0);
+			for (int ending = 0; ending < ENDINGS; ending++)
+			{
+				auto* table = s_Generated.data() + (size_t)WORDS * ending;
+
+				Generator generator((Ending)ending, s_Tables);
+				generator.Run(threadCount);
+				generator.Pack(table);
+
+				s_Tables[ending] = table;
+			}
+		}
+
+		// Four-man endings: piece A of the strong side against piece B of the weak side, or both on the
+		// strong side. Ordered so captures and promotions only lead to three-man endings and to the ones
+		// before, which is why endings nobody asks for directly (KBKB, KNKP, ...) are here as well
+		struct FourManEnding
+		{
+			pieces::Type PieceA;
+			pieces::Type PieceB;
+			bool IsPieceBStrong;
+		};
+
+		constexpr std::array FOUR_MAN_ENDINGS{
+				FourManEnding{ pieces::Type::Queen, pieces::Type::Queen, false },
+				FourManEnding{ pieces::Type::Queen, pieces::Type::Rook, false },
+				FourManEnding{ pieces::Type::Queen, pieces::Type::Bishop, false },
+				FourManEnding{ pieces::Type::Queen, pieces::Type::Knight, false },
+				FourManEnding{ pieces::Type::Rook, pieces::Type::Rook, false },
+				FourManEnding{ pieces::Type::Rook, pieces::Type::Bishop, false },
+				FourManEnding{ pieces::Type::Rook, pieces::Type::Knight, false },
+				FourManEnding{ pieces::Type::Bishop, pieces::Type::Bishop, false },
+				FourManEnding{ pieces::Type::Bishop, pieces::Type::Knight, false },
+				FourManEnding{ pieces::Type::Knight, pieces::Type::Knight, false },
+				FourManEnding{ pieces::Type::Bishop, pieces::Type::Knight, true },
+				FourManEnding{ pieces::Type::Queen, pieces::Type::Pawn, false },
+				FourManEnding{ pieces::Type::Rook, pieces::Type::Pawn, false },
+				FourManEnding{ pieces::Type::Bishop, pieces::Type::Pawn, false },
+				FourManEnding{ pieces::Type::Knight, pieces::Type::Pawn, false },
+				FourManEnding{ pieces::Type::Pawn, pieces::Type::Pawn, false }
+		};
+		constexpr int FOUR_MAN_ENDING_COUNT = (int)FOUR_MAN_ENDINGS.size();
+
+		// Side to move, strong king on files a-d (mirrored otherwise), weak king, piece A, piece B.
+		// Two bits per position hold the side to move relative Result
+		constexpr int FOUR_MAN_KING_SQUARES = BOARD_SQUARES / 2;
+		constexpr int FOUR_MAN_POSITIONS =
+				pieces::COLORS * FOUR_MAN_KING_SQUARES * BOARD_SQUARES * BOARD_SQUARES * BOARD_SQUARES;
+		constexpr int FOUR_MAN_WORDS = FOUR_MAN_POSITIONS / 32;
+
+		constexpr std::string_view FOUR_MAN_FILE_NAME = "bitbases4.bin";
+
+		std::array<Table, FOUR_MAN_ENDING_COUNT> s_FourManTables{};
+		std::vector<uint64_t> s_FourManGenerated;
+		std::atomic_bool s_FourManReady = false;
+
+		// A king or piece of a position with up to four men. Side 0 plays up the board like white
+		struct Man
+		{
+			int Side;
+			pieces::Type Type;
+			int Square;
+		};
+
+		// The kings of sides 0 and 1 come first
+		struct Position
+		{
+			std::array<Man, 4> Men;
+			int Count;
+			int SideToMove;
+		};
+
+		int GetFourManIndex(const int sideToMove, int strongKing, int weakKing, int pieceA, int pieceB)
+		{
+			if (strongKing % BOARD_SIZE >= BOARD_SIZE / 2)
+			{
+				strongKing ^= BOARD_SIZE - 1;
+				weakKing ^= BOARD_SIZE - 1;
+				pieceA ^= BOARD_SIZE - 1;
+				pieceB ^= BOARD_SIZE - 1;
+			}
+
+			const int kingIndex = strongKing / BOARD_SIZE * (BOARD_SIZE / 2) + strongKing % BOARD_SIZE;
+			return (((sideToMove * FOUR_MAN_KING_SQUARES + kingIndex) * BOARD_SQUARES + weakKing) * BOARD_SQUARES
+					+ pieceA) * BOARD_SQUARES + pieceB;
+		}
+
+		Result GetFourManResult(const Table table, const int index)
+		{
+			return (Result)((table[index / 32] >> (index % 32 * 2)) & 3);
+		}
+
+		constexpr Result Invert(const Result result)
+		{
+			return result == Result::Win ? Result::Loss : result == Result::Loss ? Result::Win : result;
+		}
+
+		// For the side choosing between them, Unknown ranks below everything
+		constexpr Result GetBetter(const Result a, const Result b)
+		{
+			constexpr std::array<int, 4> RANKS{ 0, 2, 3, 1 };
+			return RANKS[(int)a] >= RANKS[(int)b] ? a : b;
+		}
+
+		Bitboard GetAttacks(const Man& man, const Bitboard occupancy)
+		{
+			const auto square = Square(man.Square);
+			switch (man.Type)
+			{
+			case pieces::Type::Pawn:
+				return lookups::GetPawnAttacks(square, man.Side == 0 ? pieces::Color::White : pieces::Color::Black);
+			case pieces::Type::Knight:
+				return lookups::GetKnightMoves(square);
+			case pieces::Type::Bishop:
+				return lookups::GetSliderMoves<pieces::Type::Bishop>(square, occupancy);
+			case pieces::Type::Rook:
+				return lookups::GetSliderMoves<pieces::Type::Rook>(square, occupancy);
+			case pieces::Type::Queen:
+				return lookups::GetSliderMoves<pieces::Type::Queen>(square, occupancy);
+			default:
+				return lookups::GetKingMoves(square);
+			}
+		}
+
+		Bitboard GetOccupancy(const Position& position)
+		{
+			Bitboard occupancy;
+			for (int i = 0; i < position.Count; i++)
+			{
+				occupancy.SetAt(position.Men[i].Square);
+			}
+			return occupancy;
+		}
+
+		bool IsInCheck(const Position& position, const int side)
+		{
+			const auto occupancy = GetOccupancy(position);
+			const int king = position.Men[side].Square;
+			for (int i = 0; i < position.Count; i++)
+			{
+				if (position.Men[i].Side != side && GetAttacks(position.Men[i], occupancy).TestAt(king))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		Result ProbeThreeMan(const Position& position)
+		{
+			const auto& piece = position.Men[2];
+			const auto ending = std::find(ENDING_PIECES.begin(), ENDING_PIECES.end(), piece.Type);
+			if (ending == ENDING_PIECES.end())
+			{
+				// A minor piece can not mate
+				return Result::Draw;
+			}
+
+			// Mirror ranks so the strong side plays up the board
+			const int flip = piece.Side == 0 ? 0 : BOARD_SQUARES - BOARD_SIZE;
+			const bool strongToMove = position.SideToMove == piece.Side;
+			const auto index = GetIndex(strongToMove, position.Men[piece.Side].Square ^ flip,
+					position.Men[1 - piece.Side].Square ^ flip, piece.Square ^ flip);
+
+			if (!IsWin(s_Tables[ending - ENDING_PIECES.begin()], index))
+			{
+				return Result::Draw;
+			}
+			return strongToMove ? Result::Win : Result::Loss;
+		}
+
+		// Unknown if the ending is not generated yet
+		Result ProbeFourMan(const Position& position)
+		{
+			for (int ending = 0; ending < FOUR_MAN_ENDING_COUNT; ending++)
+			{
+				const auto& definition = FOUR_MAN_ENDINGS[ending];
+				if (!s_FourManTables[ending])
+				{
+					continue;
+				}
+
+				for (int strong = 0; strong < 2; strong++)
+				{
+					const int sideB = definition.IsPieceBStrong ? strong : 1 - strong;
+					for (int a = 2; a < 4; a++)
+					{
+						const auto& pieceA = position.Men[a];
+						const auto& pieceB = position.Men[5 - a];
+						if (pieceA.Side != strong || pieceA.Type != definition.PieceA || pieceB.Side != sideB
+								|| pieceB.Type != definition.PieceB)
+						{
+							continue;
+						}
+
+						const int flip = strong == 0 ? 0 : BOARD_SQUARES - BOARD_SIZE;
+						const auto index = GetFourManIndex(position.SideToMove == strong ? 0 : 1,
+								position.Men[strong].Square ^ flip, position.Men[1 - strong].Square ^ flip,
+								pieceA.Square ^ flip, pieceB.Square ^ flip);
+						return GetFourManResult(s_FourManTables[ending], index);
+					}
+				}
+			}
+
+			return Result::Unknown;
+		}
+
+		Result Lookup(const Position& position)
+		{
+			switch (position.Count)
+			{
+			case 2:
+				return Result::Draw;
+			case 3:
+				return ProbeThreeMan(position);
+			default:
+				return ProbeFourMan(position);
+			}
+		}
+
+		enum struct MoveKind
+		{
+			Quiet,
+			DoublePush,
+			// Capture or promotion, the position after it is in another table
+			Conversion
+		};
+
+		// Legal moves of the side to move as the positions after them, with the destination square
+		template<typename F>
+		void ForEachMove(const Position& position, const F& function)
+		{
+			const int side = position.SideToMove;
+			const auto occupancy = GetOccupancy(position);
+
+			Bitboard own, enemies;
+			for (int i = 0; i < position.Count; i++)
+			{
+				(position.Men[i].Side == side ? own : enemies).SetAt(position.Men[i].Square);
+			}
+			// Valid positions never have the king of the side not to move attacked
+			enemies.ResetAt(position.Men[1 - side].Square);
+
+			for (int i = 0; i < position.Count; i++)
+			{
+				const auto& man = position.Men[i];
+				if (man.Side != side)
+				{
+					continue;
+				}
+
+				const auto tryMove = [&](const int to, const pieces::Type type, const bool isDoublePush)
+				{
+					Position child = position;
+					child.Men[i].Square = to;
+					child.Men[i].Type = type;
+					child.SideToMove = 1 - side;
+
+					bool isCapture = false;
+					for (int j = 2; j < child.Count; j++)
+					{
+						if (j != i && child.Men[j].Square == to)
+						{
+							child.Men[j] = child.Men[child.Count - 1];
+							child.Count--;
+							isCapture = true;
+							break;
+						}
+					}
+
+					if (IsInCheck(child, side))
+					{
+						return;
+					}
+
+					const auto kind = isCapture || type != man.Type ? MoveKind::Conversion :
+									  isDoublePush ? MoveKind::DoublePush : MoveKind::Quiet;
+					function(child, kind, to);
+				};
+
+				if (man.Type != pieces::Type::Pawn)
+				{
+					auto targets = GetAttacks(man, occupancy) & ~own & ~Bitboard().WithSet(position.Men[1 - side].Square);
+					while (targets)
+					{
+						tryMove(targets.PopFirstSetBit(), man.Type, false);
+					}
+					continue;
+				}
+
+				const int forward = side == 0 ? -BOARD_SIZE : BOARD_SIZE;
+				const int lastRank = side == 0 ? 0 : BOARD_SIZE - 1;
+				const int startRank = side == 0 ? BOARD_SIZE - 2 : 1;
+
+				const auto pawnMove = [&](const int to)
+				{
+					if (to / BOARD_SIZE != lastRank)
+					{
+						tryMove(to, pieces::Type::Pawn, false);
+						return;
+					}
+					for (const auto type : { pieces::Type::Queen, pieces::Type::Rook, pieces::Type::Bishop,
+											 pieces::Type::Knight })
+					{
+						tryMove(to, type, false);
+					}
+				};
+
+				const int push = man.Square + forward;
+				if (!occupancy.TestAt(push))
+				{
+					pawnMove(push);
+					if (man.Square / BOARD_SIZE == startRank && !occupancy.TestAt(push + forward))
+					{
+						tryMove(push + forward, pieces::Type::Pawn, true);
+					}
+				}
+
+				auto captures = GetAttacks(man, occupancy) & enemies;
+				while (captures)
+				{
+					pawnMove(captures.PopFirstSetBit());
+				}
+			}
+		}
+
+		// Side to move relative result of the best en passant capture of the pawn that just made a double push
+		// to pushedSquare, Unknown if there is none
+		Result GetEnPassantResult(const Position& position, const int pushedSquare)
+		{
+			const int side = position.SideToMove;
+			const int passedSquare = pushedSquare + (side == 0 ? -BOARD_SIZE : BOARD_SIZE);
+
+			auto best = Result::Unknown;
+			for (int i = 2; i < position.Count; i++)
+			{
+				const auto& man = position.Men[i];
+				if (man.Side != side || man.Type != pieces::Type::Pawn
+						|| !GetAttacks(man, Bitboard()).TestAt(passedSquare))
+				{
+					continue;
+				}
+
+				Position child = position;
+				child.Men[i].Square = passedSquare;
+				child.SideToMove = 1 - side;
+				for (int j = 2; j < child.Count; j++)
+				{
+					if (child.Men[j].Square == pushedSquare)
+					{
+						child.Men[j] = child.Men[child.Count - 1];
+						child.Count--;
+						break;
+					}
+				}
+
+				if (!IsInCheck(child, side))
+				{
+					best = GetBetter(best, Invert(Lookup(child)));
+				}
+			}
+
+			return best;
+		}
+
+		// Positions one move before, without captures or promotions, so they are in the same table.
+		// The callback also gets the square the moved man stands on and whether it was a double push
+		template<typename F>
+		void ForEachUnMove(const Position& position, const F& function)
+		{
+			const int side = 1 - position.SideToMove;
+			const auto occupancy = GetOccupancy(position);
+
+			for (int i = 0; i < position.Count; i++)
+			{
+				const auto& man = position.Men[i];
+				if (man.Side != side)
+				{
+					continue;
+				}
+
+				const auto unMove = [&](const int from, const bool isDoublePush)
+				{
+					Position parent = position;
+					parent.Men[i].Square = from;
+					parent.SideToMove = side;
+					function(parent, man.Square, isDoublePush);
+				};
+
+				if (man.Type != pieces::Type::Pawn)
+				{
+					auto sources = GetAttacks(man, occupancy) & ~occupancy;
+					while (sources)
+					{
+						unMove(sources.PopFirstSetBit(), false);
+					}
+					continue;
+				}
+
+				const int backward = side == 0 ? BOARD_SIZE : -BOARD_SIZE;
+				const int from = man.Square + backward;
+				const int fromRank = from / BOARD_SIZE;
+				if (from < 0 || from >= BOARD_SQUARES || fromRank == 0 || fromRank == BOARD_SIZE - 1
+						|| occupancy.TestAt(from))
+				{
+					continue;
+				}
+				unMove(from, false);
+
+				const int startRank = side == 0 ? BOARD_SIZE - 2 : 1;
+				const int doubleFrom = from + backward;
+				if (doubleFrom / BOARD_SIZE == startRank && !occupancy.TestAt(doubleFrom))
+				{
+					unMove(doubleFrom, true);
+				}
+			}
+		}
+
+		enum struct FourManState : uint8_t
+		{
+			Invalid, Unknown, Draw, Win, Loss
+		};
+
+		// Retrograde analysis: positions decided at the start are propagated back to the positions before them.
+		// A position is won if some move reaches a lost one and lost once every move reaches a won one,
+		// counted down per position. Everything never decided is a draw
+		class FourManGenerator
+		{
+		public:
+			explicit FourManGenerator(const FourManEnding& ending)
+					:m_Ending(ending), m_States(FOUR_MAN_POSITIONS), m_MovesLeft(FOUR_MAN_POSITIONS)
+			{
+			}
+
+			void Run(const int threadCount)
+			{
+				std::vector<int> frontier;
+				std::mutex frontierMutex;
+
+				ForEachChunk(threadCount, FOUR_MAN_POSITIONS, [this, &frontier, &frontierMutex](const int begin,
+						const int end)
+				{
+					std::vector<int> decided;
+					for (int index = begin; index < end; index++)
+					{
+						const auto state = Initialize(index);
+						m_States[index].store(state, std::memory_order_relaxed);
+						if (state == FourManState::Win || state == FourManState::Loss)
+						{
+							decided.push_back(index);
+						}
+					}
+
+					std::scoped_lock lock(frontierMutex);
+					frontier.insert(frontier.end(), decided.begin(), decided.end());
+					return false;
+				});
+
+				while (!frontier.empty())
+				{
+					std::vector<int> next;
+					ForEachChunk(threadCount, (int)frontier.size(), [this, &frontier, &next, &frontierMutex](
+							const int begin, const int end)
+					{
+						std::vector<int> decided;
+						for (int i = begin; i < end; i++)
+						{
+							Propagate(frontier[i], decided);
+						}
+
+						std::scoped_lock lock(frontierMutex);
+						next.insert(next.end(), decided.begin(), decided.end());
+						return false;
+					});
+					frontier = std::move(next);
+				}
+			}
+
+			void Pack(uint64_t* output) const
+			{
+				std::memset(output, 0, sizeof(uint64_t) * FOUR_MAN_WORDS);
+				for (int index = 0; index < FOUR_MAN_POSITIONS; index++)
+				{
+					const auto state = m_States[index].load(std::memory_order_relaxed);
+					const auto result = state == FourManState::Win ? Result::Win :
+										state == FourManState::Loss ? Result::Loss :
+										state == FourManState::Invalid ? Result::Unknown : Result::Draw;
+					output[index / 32] |= (uint64_t)result << (index % 32 * 2);
+				}
+			}
+
+		private:
+			NODISCARD Position Decode(const int index) const
+			{
+				const int kingIndex = index / (BOARD_SQUARES * BOARD_SQUARES * BOARD_SQUARES) % FOUR_MAN_KING_SQUARES;
+				const int strongKing = kingIndex / (BOARD_SIZE / 2) * BOARD_SIZE + kingIndex % (BOARD_SIZE / 2);
+
+				Position position{};
+				position.Count = 4;
+				position.SideToMove = index / (FOUR_MAN_KING_SQUARES * BOARD_SQUARES * BOARD_SQUARES * BOARD_SQUARES);
+				position.Men[0] = { 0, pieces::Type::King, strongKing };
+				position.Men[1] = { 1, pieces::Type::King, index / (BOARD_SQUARES * BOARD_SQUARES) % BOARD_SQUARES };
+				position.Men[2] = { 0, m_Ending.PieceA, index / BOARD_SQUARES % BOARD_SQUARES };
+				position.Men[3] = { m_Ending.IsPieceBStrong ? 0 : 1, m_Ending.PieceB, index % BOARD_SQUARES };
+				return position;
+			}
+
+			NODISCARD static int GetIndex(const Position& position)
+			{
+				return GetFourManIndex(position.SideToMove, position.Men[0].Square, position.Men[1].Square,
+						position.Men[2].Square, position.Men[3].Square);
+			}
+
+			NODISCARD static bool IsValid(const Position& position)
+			{
+				if (GetOccupancy(position).PopCount() != position.Count
+						|| lookups::GetKingMoves(Square(position.Men[0].Square)).TestAt(position.Men[1].Square))
+				{
+					return false;
+				}
+
+				for (int i = 2; i < position.Count; i++)
+				{
+					const int rank = position.Men[i].Square / BOARD_SIZE;
+					if (position.Men[i].Type == pieces::Type::Pawn && (rank == 0 || rank == BOARD_SIZE - 1))
+					{
+						return false;
+					}
+				}
+
+				return !IsInCheck(position, 1 - position.SideToMove);
+			}
+
+			NODISCARD FourManState Initialize(const int index)
+			{
+				const auto position = Decode(index);
+				if (!IsValid(position))
+				{
+					return FourManState::Invalid;
+				}
+
+				bool hasMove = false;
+				bool isWin = false;
+				int movesLeft = 0;
+				ForEachMove(position, [&hasMove, &isWin, &movesLeft](const Position& child, const MoveKind kind,
+						const int to)
+				{
+					hasMove = true;
+					switch (kind)
+					{
+					case MoveKind::Quiet:
+						movesLeft++;
+						break;
+					case MoveKind::DoublePush:
+						// Decided right away if en passant wins, it never changes then
+						if (GetEnPassantResult(child, to) != Result::Win)
+						{
+							movesLeft++;
+						}
+						break;
+					case MoveKind::Conversion:
+					{
+						const auto result = Lookup(child);
+						assert(result != Result::Unknown);
+						if (result == Result::Loss)
+						{
+							isWin = true;
+						}
+						else if (result != Result::Win)
+						{
+							movesLeft++;
+						}
+						break;
+					}
+					}
+				});
+
+				if (!hasMove)
+				{
+					return IsInCheck(position, position.SideToMove) ? FourManState::Loss : FourManState::Draw;
+				}
+				if (isWin)
+				{
+					return FourManState::Win;
+				}
+				if (movesLeft == 0)
+				{
+					return FourManState::Loss;
+				}
+
+				m_MovesLeft[index].store((uint8_t)movesLeft, std::memory_order_relaxed);
+				return FourManState::Unknown;
+			}
+
+			void Propagate(const int index, std::vector<int>& decided)
+			{
+				const auto position = Decode(index);
+				const bool isLoss = m_States[index].load(std::memory_order_relaxed) == FourManState::Loss;
+
+				ForEachUnMove(position, [this, &position, &decided, isLoss](const Position& parent, const int square,
+						const bool isDoublePush)
+				{
+					const int parentIndex = GetIndex(parent);
+					if (m_States[parentIndex].load(std::memory_order_relaxed) != FourManState::Unknown)
+					{
+						return;
+					}
+
+					// After a double push, the side to move picks the better of this position and en passant
+					bool isChildLoss = isLoss;
+					if (isDoublePush)
+					{
+						const auto enPassant = GetEnPassantResult(position, square);
+						if (enPassant == Result::Win)
+						{
+							return;
+						}
+						isChildLoss &= enPassant == Result::Unknown || enPassant == Result::Loss;
+						if (isLoss && !isChildLoss)
+						{
+							return;
+						}
+					}
+
+					auto expected = FourManState::Unknown;
+					if (isChildLoss)
+					{
+						if (m_States[parentIndex].compare_exchange_strong(expected, FourManState::Win))
+						{
+							decided.push_back(parentIndex);
+						}
+					}
+					else if (m_MovesLeft[parentIndex].fetch_sub(1, std::memory_order_relaxed) == 1
+							&& m_States[parentIndex].compare_exchange_strong(expected, FourManState::Loss))
+					{
+						decided.push_back(parentIndex);
+					}
+				});
+			}
+
+			const FourManEnding& m_Ending;
+			std::vector<std::atomic<FourManState>> m_States;
+			std::vector<std::atomic<uint8_t>> m_MovesLeft;
+		};
+
+		void GenerateFourMan(const int threadCount)
+		{
+			utils::ScopedTimer timer(__FILE__, true);
+
+			s_FourManGenerated.assign((size_t)FOUR_MAN_WORDS * FOUR_MAN_ENDING_COUNT, 0);
+			for (int ending = 0; ending < FOUR_MAN_ENDING_COUNT; ending++)
+			{
+				auto* table = s_FourManGenerated.data() + (size_t)FOUR_MAN_WORDS * ending;
+
+				FourManGenerator generator(FOUR_MAN_ENDINGS[ending]);
+				generator.Run(threadCount);
+				generator.Pack(table);
+
+				s_FourManTables[ending] = table;
+			}
+		}
+
+		bool MapFourMan(const std::filesystem::path& path)
+		{
+			const auto* words = TryMap(path, FOUR_MAN_ENDING_COUNT, FOUR_MAN_WORDS);
+			if (!words)
+			{
+				return false;
+			}
+
+			for (int ending = 0; ending < FOUR_MAN_ENDING_COUNT; ending++)
+			{
+				s_FourManTables[ending] = words + (size_t)FOUR_MAN_WORDS * ending;
+			}
+			return true;
+		}
+
+		bool MapThreeMan(const std::filesystem::path& path)
+		{
+			const auto* words = TryMap(path, ENDINGS, WORDS);
+			if (!words)
+			{
+				return false;
+			}
+
+			for (int ending = 0; ending < ENDINGS; ending++)
+			{
+				s_Tables[ending] = words + (size_t)WORDS * ending;
+			}
+			return true;
+		}
+	}
+
+	bool Init(const std::string_view cacheDirectory)
+	{
+		std::scoped_lock lock(s_InitMutex);
+
+		const int threadCount = (int)std::max(1u, std::thread::hardware_concurrency());
+		const auto directory = std::filesystem::path(cacheDirectory);
+
+		if (!s_Ready)
+		{
+			if (cacheDirectory.empty() || !MapThreeMan(directory / FILE_NAME))
+			{
+				Generate(threadCount);
+				if (!cacheDirectory.empty())
+				{
+					Store(directory / FILE_NAME, ENDINGS, WORDS, s_Generated);
+				}
+			}
+			s_Ready = true;
+		}
+
+		// Four-man tables take too long for the first use in a search, they are only built for a cache
+		if (!cacheDirectory.empty() && !s_FourManReady)
+		{
+			if (!MapFourMan(directory / FOUR_MAN_FILE_NAME))
+			{
+				GenerateFourMan(threadCount);
+				Store(directory / FOUR_MAN_FILE_NAME, FOUR_MAN_ENDING_COUNT, FOUR_MAN_WORDS, s_FourManGenerated);
+			}
+			s_FourManReady = true;
+		}
+
+		return true;
+	}
+
+	bool IsReady()
+	{
+		return s_Ready.load(std::memory_order_relaxed);
+	}
+
+	int GetMaxPieces()
+	{
+		if (!IsReady())
+		{
+			return 0;
+		}
+		return s_FourManReady.load(std::memory_order_acquire) ? 4 : 3;
+	}
+
+	Result Probe(const core::Board& board)
+	{
+		const int count = board.occupancy().PopCount();
+		if (count < 3 || count > GetMaxPieces() || board.castlingRights().value() != 0)
+		{
+			return Result::Unknown;
+		}
+
+		Position position{};
+		position.SideToMove = board.colorToPlay() == pieces::Color::White ? 0 : 1;
+		position.Men[0] = { 0, pieces::Type::King, board.GetKingSquare(pieces::Color::White).value() };
+		position.Men[1] = { 1, pieces::Type::King, board.GetKingSquare(pieces::Color::Black).value() };
+		position.Count = 2;
+
+		auto pieces = board.occupancy() & ~board.GetPieces(pieces::Type::King);
+		while (pieces)
+		{
+			const int square = pieces.PopFirstSetBit();
+			const auto piece = board.GetPiece(Square(square));
+			position.Men[position.Count++] = { piece.color() == pieces::Color::White ? 0 : 1, piece.type(), square };
+		}
+
+		const auto result = Lookup(position);
+
+		// The tables hold positions without an en passant capture, it is one more choice for the side to move
+		const auto epSquare = board.GetEpSquare();
+		if (result == Result::Unknown || !epSquare.IsValid())
+		{
+			return result;
+		}
+
+		const int pushedSquare = epSquare.value() + (position.SideToMove == 0 ? BOARD_SIZE : -BOARD_SIZE);
+		return GetBetter(result, GetEnPassantResult(position, pushedSquare));
+	}
+}
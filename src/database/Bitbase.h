@@ -0,0 +1,35 @@
+//
+// Created by matvey on 18.10.26.
+//
+
+#pragma once
+
+#include <string_view>
+#include "../core/Board.h"
+
+namespace chess::database::bitbase
+{
+	// Win/draw/loss for the three-man endings (king and pawn, rook or queen against a lone king) and, once
+	// loaded from a cache directory, the four-man endings with at most one piece per side or a bishop and
+	// a knight together. The four-man tables take minutes to generate, so they are never built on first use
+	// in a search, only by Init with a cache directory. Larger endings are left to the Syzygy tablebases.
+	// Returns the largest piece count covered now, 0 before Init
+	NODISCARD int GetMaxPieces();
+
+	// Side to move relative
+	enum struct Result : uint8_t
+	{
+		Unknown,
+		Draw,
+		Win,
+		Loss
+	};
+
+	// Generates the bitbases once. With a cache directory they are memory-mapped from there,
+	// or written there after generation for the next run. Without one only the three-man tables are built
+	bool Init(std::string_view cacheDirectory = {});
+	NODISCARD bool IsReady();
+
+	// Unknown for positions the bitbases do not cover, with castling rights or before Init
+	NODISCARD Result Probe(const core::Board& board);
+}
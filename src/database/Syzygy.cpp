@@ -0,0 +1,223 @@
+//
+// Created by matvey on 18.10.26.
+//
+
+#include "Syzygy.h"
+
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+#ifdef CHESS_USE_FATHOM
+#include <tbprobe.h>
+#include "../core/moves/MoveGeneration.h"
+#endif
+
+namespace chess::database::syzygy
+{
+	using namespace core;
+
+	namespace
+	{
+		std::mutex s_InitMutex;
+		std::atomic_int s_MaxPieces = 0;
+
+#ifdef CHESS_USE_FATHOM
+		// Fathom numbers squares from a1, the board from a8: swapping the bytes mirrors the ranks
+		uint64_t ToFathom(const Bitboard bitboard)
+		{
+			return __builtin_bswap64((uint64_t)bitboard);
+		}
+
+		unsigned ToFathom(const Square square)
+		{
+			return square.IsValid() ? (unsigned)(square.value() ^ 56) : 0;
+		}
+
+		Square FromFathom(const unsigned square)
+		{
+			return Square((int)square ^ 56);
+		}
+
+		struct Position
+		{
+			uint64_t White;
+			uint64_t Black;
+			uint64_t Kings;
+			uint64_t Queens;
+			uint64_t Rooks;
+			uint64_t Bishops;
+			uint64_t Knights;
+			uint64_t Pawns;
+			unsigned EpSquare;
+			bool WhiteToPlay;
+
+			explicit Position(const Board& board)
+					:White(ToFathom(board.GetPieces(pieces::Color::White))),
+					 Black(ToFathom(board.GetPieces(pieces::Color::Black))),
+					 Kings(ToFathom(board.GetPieces(pieces::Type::King))),
+					 Queens(ToFathom(board.GetPieces(pieces::Type::Queen))),
+					 Rooks(ToFathom(board.GetPieces(pieces::Type::Rook))),
+					 Bishops(ToFathom(board.GetPieces(pieces::Type::Bishop))),
+					 Knights(ToFathom(board.GetPieces(pieces::Type::Knight))),
+					 Pawns(ToFathom(board.GetPieces(pieces::Type::Pawn))),
+					 EpSquare(ToFathom(board.GetEpSquare())),
+					 WhiteToPlay(board.colorToPlay() == pieces::Color::White)
+			{
+			}
+		};
+
+		Wdl ToWdl(const unsigned wdl)
+		{
+			switch (wdl)
+			{
+			case TB_LOSS:
+				return Wdl::Loss;
+			case TB_BLESSED_LOSS:
+				return Wdl::BlessedLoss;
+			case TB_DRAW:
+				return Wdl::Draw;
+			case TB_CURSED_WIN:
+				return Wdl::CursedWin;
+			case TB_WIN:
+				return Wdl::Win;
+			default:
+				return Wdl::Unknown;
+			}
+		}
+
+		pieces::Type GetPromotion(const moves::Type type)
+		{
+			switch (type)
+			{
+			case moves::Type::QueenPQ:
+			case moves::Type::QueenPC:
+				return pieces::Type::Queen;
+			case moves::Type::RookPQ:
+			case moves::Type::RookPC:
+				return pieces::Type::Rook;
+			case moves::Type::BishopPQ:
+			case moves::Type::BishopPC:
+				return pieces::Type::Bishop;
+			case moves::Type::KnightPQ:
+			case moves::Type::KnightPC:
+				return pieces::Type::Knight;
+			default:
+				return pieces::Type::Pawn;
+			}
+		}
+
+		pieces::Type FromFathomPromotion(const unsigned promotion)
+		{
+			switch (promotion)
+			{
+			case TB_PROMOTES_QUEEN:
+				return pieces::Type::Queen;
+			case TB_PROMOTES_ROOK:
+				return pieces::Type::Rook;
+			case TB_PROMOTES_BISHOP:
+				return pieces::Type::Bishop;
+			case TB_PROMOTES_KNIGHT:
+				return pieces::Type::Knight;
+			default:
+				return pieces::Type::Pawn;
+			}
+		}
+#endif
+	}
+
+	bool Init(const std::string_view path)
+	{
+		std::scoped_lock lock(s_InitMutex);
+#ifdef CHESS_USE_FATHOM
+		if (!tb_init(std::string(path).c_str()))
+		{
+			std::cout << "Failed to initialize tablebases from " << path << '\n';
+			s_MaxPieces = 0;
+			return false;
+		}
+
+		s_MaxPieces = (int)TB_LARGEST;
+		std::cout << "Tablebases up to " << TB_LARGEST << " pieces found in " << path << '\n';
+		return TB_LARGEST > 0;
+#else
+		std::cout << "Built without tablebase support, set CHESS_FATHOM_DIR to enable it. Ignoring " << path
+				  << '\n';
+		return false;
+#endif
+	}
+
+	void Free()
+	{
+		std::scoped_lock lock(s_InitMutex);
+		s_MaxPieces = 0;
+#ifdef CHESS_USE_FATHOM
+		tb_free();
+#endif
+	}
+
+	int GetMaxPieces()
+	{
+		return s_MaxPieces.load(std::memory_order_relaxed);
+	}
+
+	Wdl ProbeWdl(const Board& board)
+	{
+#ifdef CHESS_USE_FATHOM
+		if (board.occupancy().PopCount() > GetMaxPieces() || board.halfMoves() != 0
+				|| board.castlingRights().value() != 0)
+		{
+			return Wdl::Unknown;
+		}
+
+		const Position position(board);
+		const auto result = tb_probe_wdl(position.White, position.Black, position.Kings, position.Queens,
+				position.Rooks, position.Bishops, position.Knights, position.Pawns, 0, 0, position.EpSquare,
+				position.WhiteToPlay);
+		return result == TB_RESULT_FAILED ? Wdl::Unknown : ToWdl(result);
+#else
+		(void)board;
+		return Wdl::Unknown;
+#endif
+	}
+
+	std::optional<RootResult> ProbeRoot(const Board& board)
+	{
+#ifdef CHESS_USE_FATHOM
+		if (board.occupancy().PopCount() > GetMaxPieces() || board.castlingRights().value() != 0)
+		{
+			return std::nullopt;
+		}
+
+		const Position position(board);
+		const auto result = tb_probe_root(position.White, position.Black, position.Kings, position.Queens,
+				position.Rooks, position.Bishops, position.Knights, position.Pawns, (unsigned)board.halfMoves(), 0,
+				position.EpSquare, position.WhiteToPlay, nullptr);
+		if (result == TB_RESULT_FAILED || result == TB_RESULT_CHECKMATE || result == TB_RESULT_STALEMATE)
+		{
+			return std::nullopt;
+		}
+
+		const auto start = FromFathom(TB_GET_FROM(result));
+		const auto end = FromFathom(TB_GET_TO(result));
+		const auto promotion = FromFathomPromotion(TB_GET_PROMOTES(result));
+
+		moves::Move moves[moves::MAX_MOVES];
+		const auto movesEnd = moves::GenerateMoves<moves::Legality::Legal>(board, moves);
+		for (auto* it = moves; it != movesEnd; it++)
+		{
+			if (it->start() == start && it->end() == end && GetPromotion(it->type()) == promotion)
+			{
+				return RootResult{ .BestMove = *it, .Result = ToWdl(TB_GET_WDL(result)),
+						.Dtz = (int)TB_GET_DTZ(result) };
+			}
+		}
+
+		return std::nullopt;
+#else
+		(void)board;
+		return std::nullopt;
+#endif
+	}
+}
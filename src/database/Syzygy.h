@@ -0,0 +1,47 @@
+//
+// Created by matvey on 18.10.26.
+//
+
+#pragma once
+
+#include <optional>
+#include <string_view>
+#include "../core/Board.h"
+#include "../core/moves/Move.h"
+
+namespace chess::database::syzygy
+{
+	// Side to move relative. Cursed wins and blessed losses are decided only past the fifty move rule
+	enum struct Wdl : uint8_t
+	{
+		Unknown,
+		Loss,
+		BlessedLoss,
+		Draw,
+		CursedWin,
+		Win
+	};
+
+	struct RootResult
+	{
+		core::moves::Move BestMove;
+		Wdl Result = Wdl::Unknown;
+		int Dtz = 0;
+	};
+
+	// Memory-maps the .rtbw/.rtbz files found in path (several directories separated by ':').
+	// Returns false if no tables were found or tablebase support was not compiled in (CHESS_FATHOM_DIR).
+	// Must not be called while a search is running
+	bool Init(std::string_view path);
+	void Free();
+
+	// Largest piece count the loaded tables cover, 0 if none are loaded
+	NODISCARD int GetMaxPieces();
+
+	// Unknown if the position has castling rights, is not right after a capture or pawn move,
+	// or its table is missing
+	NODISCARD Wdl ProbeWdl(const core::Board& board);
+
+	// Move that keeps the best result and makes progress by DTZ, accounting for the fifty move rule
+	NODISCARD std::optional<RootResult> ProbeRoot(const core::Board& board);
+}